@@ -0,0 +1,89 @@
+// runOnUiThread throughput and post-to-run latency, against the QTimer per
+// call it used before the per-thread queue. Producers post from worker
+// threads to the main thread, as core and RPC callbacks do.
+//
+//   bench_dispatch [producers] [tasks per producer]
+
+#include "main/NekoGui_Utils.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QTimer>
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    // what runOnUiThread did before the dispatcher
+    void postWithTimer(const std::function<void()> &callback) {
+        auto timer = new QTimer();
+        timer->moveToThread(QCoreApplication::instance()->thread());
+        timer->setSingleShot(true);
+        QObject::connect(timer, &QTimer::timeout, [=]() {
+            callback();
+            timer->deleteLater();
+        });
+        QMetaObject::invokeMethod(timer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
+    }
+
+    struct Result {
+        double seconds = 0;
+        std::vector<double> latencyUs;
+        int outOfOrder = 0;
+    };
+
+    Result run(const char *name, void (*post)(const std::function<void()> &), int producers, int tasks) {
+        Result result;
+        result.latencyUs.reserve(size_t(producers) * tasks);
+        std::vector<int> lastSeen(producers, -1);
+        int done = 0;
+        const int total = producers * tasks;
+
+        QElapsedTimer elapsed;
+        elapsed.start();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&, p] {
+                for (int i = 0; i < tasks; i++) {
+                    auto posted = Clock::now();
+                    post([&, p, i, posted] {
+                        // main thread
+                        result.latencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - posted).count());
+                        if (i < lastSeen[p]) result.outOfOrder++;
+                        lastSeen[p] = i;
+                        if (++done == total) QCoreApplication::quit();
+                    });
+                }
+            });
+        }
+        QCoreApplication::exec();
+        result.seconds = elapsed.nsecsElapsed() / 1e9;
+        for (auto &t: threads) t.join();
+
+        auto &l = result.latencyUs;
+        std::sort(l.begin(), l.end());
+        auto at = [&](double q) { return l[std::min(l.size() - 1, size_t(q * l.size()))]; };
+        std::printf("%-14s %10.0f tasks/s   latency us p50 %8.1f  p99 %8.1f  max %9.1f   out of order %d\n",
+                    name, total / result.seconds, at(0.5), at(0.99), l.back(), result.outOfOrder);
+        return result;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    int producers = argc > 1 ? std::max(1, atoi(argv[1])) : 4;
+    int tasks = argc > 2 ? std::max(1, atoi(argv[2])) : 100000;
+    std::printf("%d producers x %d tasks\n", producers, tasks);
+
+    // warm up both paths once, the first post creates the dispatcher
+    run("warmup", [](const std::function<void()> &cb) { runOnUiThread(cb); }, 1, 1000);
+    run("QTimer", postWithTimer, producers, tasks);
+    run("runOnUiThread", [](const std::function<void()> &cb) { runOnUiThread(cb); }, producers, tasks);
+    return 0;
+}
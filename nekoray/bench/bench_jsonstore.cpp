@@ -0,0 +1,141 @@
+// Heap footprint of a bean, with the shared JsonSchema, against the per-object
+// QMap<QString, std::shared_ptr<configItem>> every JsonStore held before.
+// Global new and delete are counted; the old map is rebuilt from the same
+// field names, the way _add filled it.
+//
+//   bench_jsonstore [objects per type]
+
+#include "fmt/includes.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QMap>
+
+namespace {
+    std::atomic<long long> liveBytes{0};
+    std::atomic<long long> liveBlocks{0};
+
+    // size in front of each block, so delete knows what it frees
+    constexpr size_t header = alignof(std::max_align_t);
+
+    void *countedNew(size_t size) {
+        auto p = static_cast<char *>(std::malloc(size + header));
+        if (p == nullptr) throw std::bad_alloc();
+        *reinterpret_cast<size_t *>(p) = size;
+        liveBytes += (long long) size;
+        liveBlocks++;
+        return p + header;
+    }
+
+    void countedDelete(void *ptr) {
+        if (ptr == nullptr) return;
+        auto p = static_cast<char *>(ptr) - header;
+        liveBytes -= (long long) *reinterpret_cast<size_t *>(p);
+        liveBlocks--;
+        std::free(p);
+    }
+} // namespace
+
+void *operator new(size_t size) { return countedNew(size); }
+void *operator new[](size_t size) { return countedNew(size); }
+void operator delete(void *p) noexcept { countedDelete(p); }
+void operator delete[](void *p) noexcept { countedDelete(p); }
+void operator delete(void *p, size_t) noexcept { countedDelete(p); }
+void operator delete[](void *p, size_t) noexcept { countedDelete(p); }
+
+namespace {
+    // configItem and JsonStore::_map as they were
+    class OldConfigItem {
+    public:
+        QString name;
+        void *ptr;
+        itemType type;
+
+        OldConfigItem(QString n, void *p, itemType t) {
+            name = std::move(n);
+            ptr = p;
+            type = t;
+        }
+    };
+
+    using OldMap = QMap<QString, std::shared_ptr<OldConfigItem>>;
+
+    // one map per store, nested stores had their own
+    void buildOldMaps(JsonStore *store, std::vector<OldMap> &maps) {
+        OldMap map;
+        for (const auto &item: store->_schema->Items()) {
+            // _add took a fresh QString from the literal
+            auto name = QString::fromUtf8(item.name.toUtf8());
+            map.insert(name, std::shared_ptr<OldConfigItem>(new OldConfigItem(name, store->_ptr(item), item.type)));
+        }
+        maps.push_back(std::move(map));
+        for (const auto &resolve: store->_stores) {
+            auto nested = resolve();
+            if (nested != nullptr) buildOldMaps(nested.get(), maps);
+        }
+    }
+
+    struct Usage {
+        long long bytes;
+        long long blocks;
+    };
+
+    Usage now() { return {liveBytes.load(), liveBlocks.load()}; }
+
+    template<typename Bean, typename... Args>
+    void measure(const char *name, int count, Args... args) {
+        // the first object of a type builds its schema nodes, keep them out
+        delete new Bean(args...);
+
+        std::vector<Bean *> beans;
+        beans.reserve(count);
+        auto before = now();
+        for (int i = 0; i < count; i++) beans.push_back(new Bean(args...));
+        auto after = now();
+
+        std::vector<std::vector<OldMap>> oldMaps(count);
+        auto beforeMaps = now();
+        for (int i = 0; i < count; i++) buildOldMaps(beans[i], oldMaps[i]);
+        auto afterMaps = now();
+
+        double bytes = double(after.bytes - before.bytes) / count;
+        double blocks = double(after.blocks - before.blocks) / count;
+        double mapBytes = double(afterMaps.bytes - beforeMaps.bytes) / count;
+        double mapBlocks = double(afterMaps.blocks - beforeMaps.blocks) / count;
+        std::printf("%-16s %3d fields   now %7.0f B %5.1f allocs   before %7.0f B %5.1f allocs   saved %5.1f%%\n",
+                    name, int(beans[0]->_schema->Items().size()),
+                    bytes, blocks, bytes + mapBytes, blocks + mapBlocks,
+                    100 * mapBytes / (bytes + mapBytes));
+
+        oldMaps.clear();
+        for (auto bean: beans) delete bean;
+    }
+} // namespace
+
+int main(int argc, char **argv) {
+    QCoreApplication app(argc, argv);
+    int count = argc > 1 ? std::max(1, atoi(argv[1])) : 10000;
+    std::printf("%d objects per type, live heap bytes and blocks per object\n", count);
+    std::printf("before counts the old field maps on top of today's object, _stores included\n");
+
+    using namespace NekoGui_fmt;
+    measure<SocksHttpBean>("socks", count, SocksHttpBean::type_Socks5);
+    measure<ShadowSocksBean>("shadowsocks", count);
+    measure<VMessBean>("vmess", count);
+    measure<TrojanVLESSBean>("trojan", count, TrojanVLESSBean::proxy_Trojan);
+    measure<TrojanVLESSBean>("vless", count, TrojanVLESSBean::proxy_VLESS);
+    measure<NaiveBean>("naive", count);
+    measure<QUICBean>("hysteria2", count, QUICBean::proxy_Hysteria2);
+    measure<QUICBean>("tuic", count, QUICBean::proxy_TUIC);
+    measure<ChainBean>("chain", count);
+    measure<BalancerBean>("balancer", count);
+    measure<CustomBean>("custom", count);
+    return 0;
+}
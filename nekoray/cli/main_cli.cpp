@@ -6,9 +6,14 @@
 #include <QTextStream>
 #include <QJsonDocument>
 #include <QJsonArray>
+#include <QDir>
+#include <QStandardPaths>
+#include <QCborArray>
 
+#include "../core/ControlSocket.hpp"
 #include "../core/NekoService_Fixed.hpp"
 #include "../core/SafetyUtils.hpp"
+#include "../db/Database.hpp"
 
 class CliApplication : public QObject {
     Q_OBJECT
@@ -39,6 +44,10 @@ public:
             "Enable additional safety checks");
         QCommandLineOption portOption({"p", "port"}, 
             "Web API server port (default: 8080)", "port", "8080");
+        QCommandLineOption fuzzyOption("fuzzy", 
+            "Fuzzy match for search");
+        QCommandLineOption localOption("local", 
+            "Run the command in this process even if a daemon is running");
 
         parser.addOption(configDirOption);
         parser.addOption(daemonOption);
@@ -48,6 +57,8 @@ public:
         parser.addOption(forceOption);
         parser.addOption(safetyOption);
         parser.addOption(portOption);
+        parser.addOption(fuzzyOption);
+        parser.addOption(localOption);
 
         // Define commands
         parser.addPositionalArgument("command", 
@@ -57,6 +68,7 @@ public:
             "  restart <profile_id> - Restart proxy with profile\n"
             "  status              - Show proxy status\n"
             "  list                - List available profiles\n"
+            "  search <text>       - Find profiles by name, address, type or group\n"
             "  daemon              - Start daemon mode with web API\n"
             "  tun-start           - Start TUN mode\n"
             "  tun-stop            - Stop TUN mode\n"
@@ -65,27 +77,12 @@ public:
 
         parser.process(arguments);
 
-        m_service = new NekoCore::NekoService(this);
-        
-        // Initialize service
         QString configDir = parser.value(configDirOption);
-        if (!m_service->initialize(configDir)) {
-            qCritical() << "Failed to initialize service";
-            return 1;
-        }
-
-        // Connect signals for logging
-        connect(m_service, &NekoCore::NekoService::logMessage,
-                this, &CliApplication::onLogMessage);
-        connect(m_service, &NekoCore::NekoService::errorOccurred,
-                this, &CliApplication::onError);
-        connect(m_service, &NekoCore::NekoService::statusChanged,
-                this, &CliApplication::onStatusChanged);
-
         m_verbose = parser.isSet(verboseOption);
         m_dryRun = parser.isSet(dryRunOption);
         m_force = parser.isSet(forceOption);
         m_enableSafety = parser.isSet(safetyOption);
+        m_configDir = configDir.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/nekoray" : configDir;
 
         // Safety checks
         if (m_enableSafety && !m_force) {
@@ -103,7 +100,31 @@ public:
         }
 
         QString command = positionalArgs.first();
+
+        // A running daemon serves the command, no second service or core
+        if (!parser.isSet(localOption) && !m_dryRun && remoteCommands.contains(command)) {
+            NekoCore::ControlClient client;
+            if (client.Connect(NekoCore::Control::SocketPath(configDir))) {
+                return runRemote(client, positionalArgs, parser.isSet(fuzzyOption));
+            }
+        }
+
+        m_service = new NekoCore::NekoService(this);
         
+        // Initialize service
+        if (!m_service->initialize(configDir)) {
+            qCritical() << "Failed to initialize service";
+            return 1;
+        }
+
+        // Connect signals for logging
+        connect(m_service, &NekoCore::NekoService::logMessage,
+                this, &CliApplication::onLogMessage);
+        connect(m_service, &NekoCore::NekoService::errorOccurred,
+                this, &CliApplication::onError);
+        connect(m_service, &NekoCore::NekoService::statusChanged,
+                this, &CliApplication::onStatusChanged);
+
         if (command == "start") {
             return handleStart(positionalArgs);
         } else if (command == "stop") {
@@ -114,6 +135,8 @@ public:
             return handleStatus();
         } else if (command == "list") {
             return handleList();
+        } else if (command == "search") {
+            return handleSearch(positionalArgs, parser.isSet(fuzzyOption));
         } else if (command == "daemon") {
             bool enableTun = parser.isSet(tunOption);
             int webPort = parser.value(portOption).toInt();
@@ -255,13 +278,45 @@ private:
         return 0;
     }
 
-    int handleList() {
-        // TODO: Implement profile listing
+    void loadProfiles() {
+        if (!NekoGui::profileManager->Profiles()->profiles.empty()) return;
+        QDir::setCurrent(m_configDir);
+        NekoGui::profileManager->LoadManager();
+    }
+
+    void printProfile(int id, const QString &type, const QString &address, const QString &name) {
         QTextStream out(stdout);
-        out << "Profile listing not yet implemented" << Qt::endl;
+        out << QString("%1\t%2\t%3\t%4").arg(QString::number(id), type, address, name) << Qt::endl;
+    }
+
+    void printProfiles(const QList<int> &ids) {
+        for (auto id: ids) {
+            auto ent = NekoGui::profileManager->GetProfile(id);
+            if (ent == nullptr) continue;
+            printProfile(id, ent->meta.type, ent->meta.address, ent->meta.name);
+        }
+    }
+
+    int handleList() {
+        loadProfiles();
+        QList<int> ids;
+        auto table = NekoGui::profileManager->Profiles();
+        for (const auto &[id, _]: table->profiles) ids << id;
+        printProfiles(ids);
         return 0;
     }
 
+    int handleSearch(const QStringList &args, bool fuzzy) {
+        if (args.size() < 2) {
+            qCritical() << "Search text required for search command";
+            return 1;
+        }
+        loadProfiles();
+        auto ids = NekoGui::profileManager->SearchProfiles(args.mid(1).join(' '), fuzzy);
+        printProfiles(ids);
+        return ids.isEmpty() ? 1 : 0;
+    }
+
     int handleDaemon(bool enableTun, int webPort) {
         Q_UNUSED(enableTun)
         Q_UNUSED(webPort)
@@ -343,6 +398,69 @@ private:
         return 0;
     }
 
+    // Commands a running daemon can serve, see daemon/ControlServer.cpp
+    const QStringList remoteCommands = {"start", "stop", "restart", "status", "list", "search", "tun-start", "tun-stop", "config"};
+
+    int runRemote(NekoCore::ControlClient &client, const QStringList &args, bool fuzzy) {
+        const auto &command = args.first();
+        if ((command == "start" || command == "restart") && args.size() < 2) {
+            qCritical() << "Profile ID required for" << command << "command";
+            return 1;
+        }
+        if (command == "search" && args.size() < 2) {
+            qCritical() << "Search text required for search command";
+            return 1;
+        }
+        if (command == "tun-start" && m_enableSafety && !m_force && !NekoCore::SafetyUtils::isTunOperationSafe()) {
+            qCritical() << "TUN operation not safe in current environment";
+            qCritical() << "Use --force to override, or run in safe environment";
+            return 1;
+        }
+
+        auto reply = client.Call(command, args.mid(1), fuzzy);
+        if (!reply.value(QStringLiteral("ok")).toBool()) {
+            onError(reply.value(QStringLiteral("error")).toString());
+            return 1;
+        }
+
+        QTextStream out(stdout);
+        auto socks = QString("%1:%2").arg(reply.value(QStringLiteral("socks")).toString()).arg(reply.value(QStringLiteral("socks_port")).toInteger());
+        auto http = QString("%1:%2").arg(reply.value(QStringLiteral("http")).toString()).arg(reply.value(QStringLiteral("http_port")).toInteger());
+        if (command == "start") {
+            out << "Proxy started successfully with profile " << args[1] << Qt::endl;
+            out << "SOCKS5: " << socks << Qt::endl;
+            out << "HTTP: " << http << Qt::endl;
+        } else if (command == "stop") {
+            out << "Proxy stopped successfully" << Qt::endl;
+        } else if (command == "restart") {
+            out << "Proxy restarted successfully with profile " << args[1] << Qt::endl;
+        } else if (command == "status") {
+            out << "Service Status: " << reply.value(QStringLiteral("status")).toString() << Qt::endl;
+            out << "Current Profile: " << reply.value(QStringLiteral("profile")).toInteger() << Qt::endl;
+            out << "TUN Mode: " << (reply.value(QStringLiteral("tun")).toBool() ? "Running" : "Stopped") << Qt::endl;
+            if (reply.value(QStringLiteral("running")).toBool()) {
+                out << "SOCKS5: " << socks << Qt::endl;
+                out << "HTTP: " << http << Qt::endl;
+                out << "Upload: " << formatBytes(reply.value(QStringLiteral("upload")).toInteger()) << Qt::endl;
+                out << "Download: " << formatBytes(reply.value(QStringLiteral("download")).toInteger()) << Qt::endl;
+            }
+        } else if (command == "list" || command == "search") {
+            auto profiles = reply.value(QStringLiteral("profiles")).toArray();
+            for (const auto &row: profiles) {
+                auto p = row.toArray();
+                printProfile(int(p[0].toInteger()), p[1].toString(), p[2].toString(), p[3].toString());
+            }
+            if (command == "search" && profiles.isEmpty()) return 1;
+        } else if (command == "tun-start") {
+            out << "TUN mode started successfully" << Qt::endl;
+        } else if (command == "tun-stop") {
+            out << "TUN mode stopped successfully" << Qt::endl;
+        } else if (command == "config") {
+            out << QJsonDocument(reply.value(QStringLiteral("config")).toMap().toJsonObject()).toJson() << Qt::endl;
+        }
+        return 0;
+    }
+
     QString formatBytes(qint64 bytes) {
         const QStringList units = {"B", "KB", "MB", "GB", "TB"};
         double size = bytes;
@@ -357,6 +475,7 @@ private:
     }
 
     NekoCore::NekoService *m_service;
+    QString m_configDir;
     bool m_verbose = false;
     bool m_dryRun = false;
     bool m_force = false;
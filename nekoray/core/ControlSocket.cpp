@@ -0,0 +1,89 @@
+#include "ControlSocket.hpp"
+
+#include <QCborArray>
+#include <QCborValue>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QStandardPaths>
+#include <QtEndian>
+
+namespace NekoCore {
+
+    namespace Control {
+        QString SocketPath(const QString &configDir) {
+            auto dir = configDir.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::ConfigLocation) + "/nekoray" : configDir;
+            auto key = QCryptographicHash::hash(QDir(dir).absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex().left(16);
+
+            auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+            if (runtimeDir.isEmpty()) runtimeDir = QDir::tempPath();
+            return QStringLiteral("%1/nekoray-%2.sock").arg(runtimeDir, QString::fromLatin1(key));
+        }
+
+        QByteArray Frame(const QCborMap &message) {
+            auto payload = message.toCborValue().toCbor();
+            QByteArray frame(4, Qt::Uninitialized);
+            qToBigEndian<quint32>(payload.size(), frame.data());
+            return frame + payload;
+        }
+
+        bool Unframe(QByteArray &buffer, QCborMap &message, bool &bad) {
+            bad = false;
+            if (buffer.size() < 4) return false;
+            auto size = qFromBigEndian<quint32>(buffer.constData());
+            if (size > MaxMessageSize) {
+                bad = true;
+                return false;
+            }
+            if (quint32(buffer.size()) < 4 + size) return false;
+
+            QCborParserError error;
+            auto value = QCborValue::fromCbor(buffer.mid(4, size), &error);
+            buffer.remove(0, 4 + size);
+            if (error.error != QCborError::NoError || !value.isMap()) {
+                bad = true;
+                return false;
+            }
+            message = value.toMap();
+            return true;
+        }
+    } // namespace Control
+
+    bool ControlClient::Connect(const QString &path, int timeoutMs) {
+        m_socket.connectToServer(path);
+        return m_socket.waitForConnected(timeoutMs);
+    }
+
+    QCborMap ControlClient::Call(const QString &cmd, const QStringList &args, bool fuzzy, int timeoutMs) {
+        QCborMap request;
+        request[QStringLiteral("cmd")] = cmd;
+        request[QStringLiteral("args")] = QCborArray::fromStringList(args);
+        if (fuzzy) request[QStringLiteral("fuzzy")] = true;
+
+        auto fail = [](const QString &error) {
+            QCborMap reply;
+            reply[QStringLiteral("ok")] = false;
+            reply[QStringLiteral("error")] = error;
+            return reply;
+        };
+
+        m_socket.write(Control::Frame(request));
+        m_socket.flush();
+
+        QElapsedTimer timer;
+        timer.start();
+        while (true) {
+            QCborMap reply;
+            bool bad;
+            if (Control::Unframe(m_buffer, reply, bad)) return reply;
+            if (bad) return fail("malformed reply from daemon");
+
+            auto left = timeoutMs - timer.elapsed();
+            if (left <= 0 || !m_socket.waitForReadyRead(int(left))) {
+                return fail(m_socket.state() == QLocalSocket::ConnectedState ? "daemon timeout" : "daemon closed the connection");
+            }
+            m_buffer += m_socket.readAll();
+        }
+    }
+
+} // namespace NekoCore
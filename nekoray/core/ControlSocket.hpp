@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QCborMap>
+#include <QLocalSocket>
+#include <QStringList>
+
+namespace NekoCore {
+
+    // Local control socket of nekoray-daemon, so nekoray-cli drives the running
+    // service instead of initializing its own and starting a second core.
+    //
+    // One socket per config directory, only the user can open it. Each message
+    // is a big-endian quint32 length followed by a CBOR map:
+    //   request: {"cmd": <command>, "args": [<string>...], "fuzzy": <bool>}
+    //   reply:   {"ok": <bool>, "error": <string>, ...fields of the command}
+    namespace Control {
+        constexpr quint32 MaxMessageSize = 64 * 1024 * 1024;
+
+        QString SocketPath(const QString &configDir);
+
+        QByteArray Frame(const QCborMap &message);
+
+        // Takes one complete message off the front of buffer. Returns false while
+        // it's incomplete, sets bad when the stream can't be a valid message.
+        bool Unframe(QByteArray &buffer, QCborMap &message, bool &bad);
+    } // namespace Control
+
+    class ControlClient {
+    public:
+        // Fails fast when no daemon listens.
+        bool Connect(const QString &path, int timeoutMs = 200);
+
+        // Sends one request and waits for its reply. On failure the reply has ok=false and the error.
+        QCborMap Call(const QString &cmd, const QStringList &args = {}, bool fuzzy = false, int timeoutMs = 60000);
+
+    private:
+        QLocalSocket m_socket;
+        QByteArray m_buffer;
+    };
+
+} // namespace NekoCore
@@ -2,11 +2,20 @@
 #include "../main/NekoGui.hpp"
 #include "../main/NekoGui_Utils.hpp"
 #include "../db/ConfigBuilder.hpp"
+#include "../db/ConfigCache.hpp"
 #include "../fmt/AbstractBean.hpp"
+#include "../sys/PortPool.hpp"
+#include "../db/traffic/TrafficHistory.hpp"
 
 #include <QApplication>
 #include <QDir>
 #include <QTextStream>
+#include <QTimer>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QTcpSocket>
 #include <QDebug>
 
 namespace NekoCore {
@@ -57,54 +66,299 @@ namespace NekoCore {
             return false;
         }
 
-        m_process = new QProcess(this);
-        connect(m_process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, &CoreManager::processFinished);
-        connect(m_process, &QProcess::readyReadStandardOutput,
-                this, &CoreManager::onReadyReadStandardOutput);
-        connect(m_process, &QProcess::readyReadStandardError,
-                this, &CoreManager::onReadyReadStandardError);
+        m_process = spawnCore();
+        if (m_process == nullptr) {
+            return false;
+        }
 
-        QStringList arguments;
-        arguments << "--disable-color" << "run" << "-c" << m_configPath;
+        m_servePorts.clear(); // a single profile, whatever was served before
+        m_currentProfileId = profileId;
+        emit logOutput(QString("Core started with PID %1").arg(m_process->processId()));
+        return true;
+    }
 
-        m_process->start(m_corePath, arguments);
-        
-        if (!m_process->waitForStarted(5000)) {
-            qWarning() << "Failed to start core process:" << m_process->errorString();
-            m_process->deleteLater();
-            m_process = nullptr;
+    bool CoreManager::serve(const QMap<int, int> &servePorts) {
+        stop();
+
+        if (m_corePath.isEmpty()) {
+            qWarning() << "Core path not set";
+            return false;
+        }
+
+        NekoGui::ConfigCache::Entry built;
+        if (NekoGui::configCache->Get(-1, servePorts, built)) {
+            m_configPath = built.path;
+        } else {
+            auto result = NekoGui::BuildServeConfig(servePorts);
+            if (!result->error.isEmpty()) {
+                qWarning() << "Failed to build serve config:" << result->error;
+                return false;
+            }
+            m_configPath = NekoGui::configCache->Put(-1, servePorts, *result, result->coreConfig);
+            if (m_configPath.isEmpty() && !writeConfig(result->coreConfig, "serve")) {
+                return false;
+            }
+        }
+
+        m_process = spawnCore();
+        if (m_process == nullptr) {
+            return false;
+        }
+
+        m_servePorts = servePorts;
+        emit logOutput(QString("Core serving %1 profiles with PID %2").arg(servePorts.size()).arg(m_process->processId()));
+        return true;
+    }
+
+    bool CoreManager::switchTo(int profileId, int graceSeconds) {
+        if (!isRunning()) {
+            return start(profileId);
+        }
+
+        auto oldController = m_controller;
+        if (!generateConfig(profileId)) {
+            m_controller = oldController;
+            qWarning() << "Failed to generate config";
             return false;
         }
 
+        // blue/green: the new core binds the same inbound ports next to the old one (reuse_addr)
+        // and the old one stops accepting once the new one is up
+        auto oldProcess = m_process;
+        auto oldServePorts = m_servePorts;
+        m_draining << oldProcess;
+        m_servePorts.clear(); // the new core serves one profile, waitForReady probes its socks port
+        m_process = spawnCore();
+        if (m_process == nullptr || !waitForReady(10000)) {
+            auto newProcess = m_process;
+            // the private controller port may have been taken since it was leased
+            if (m_controller.lease) NekoGui_sys::portPool->Recheck(m_controller.lease->port);
+            m_draining.removeOne(oldProcess);
+            m_process = oldProcess;
+            m_controller = oldController;
+            m_servePorts = oldServePorts;
+            m_coreStarted = true;
+            if (newProcess != nullptr) terminateCore(newProcess);
+            emit logOutput("[ERROR] New core failed the health check, keeping the old one");
+            return false;
+        }
+
+        // the kernel spreads new connections over every listener on a reuse_addr port,
+        // so the old core closes its listeners and only finishes what it already accepted
+        oldProcess->write("drain\n");
+
         m_currentProfileId = profileId;
-        emit logOutput(QString("Core started with PID %1").arg(m_process->processId()));
+        emit logOutput(QString("Core switched to PID %1, draining PID %2 for %3s")
+                           .arg(m_process->processId())
+                           .arg(oldProcess->processId())
+                           .arg(graceSeconds));
+
+        QTimer::singleShot(qMax(graceSeconds, 0) * 1000, this, [this, oldProcess]() {
+            if (!m_draining.removeOne(oldProcess)) return; // already stopped
+            terminateCore(oldProcess);
+            emit logOutput("Drained core process stopped");
+        });
         return true;
     }
 
-    bool CoreManager::stop() {
-        if (!m_process || m_process->state() == QProcess::NotRunning) {
+    bool CoreManager::select(int profileId) {
+        if (!isRunning() || !m_controller.selectorMembers.contains(profileId)) {
+            return false;
+        }
+        if (profileId == m_currentProfileId) {
             return true;
         }
 
-        m_process->terminate();
-        if (!m_process->waitForFinished(5000)) {
-            m_process->kill();
-            m_process->waitForFinished(2000);
+        // PUT /proxies/{selector} switches the selector in place, open connections stay up
+        auto body = QJsonObject{{"name", m_controller.selectorMembers[profileId]}};
+        QString error;
+        controllerRequest("PUT", "/proxies/proxy", QJsonObject2QString(body, true).toUtf8(), &error);
+        if (!error.isEmpty()) {
+            qWarning() << "Failed to select outbound:" << error;
+            return false;
+        }
+
+        m_currentProfileId = profileId;
+        emit logOutput(QString("Selected profile %1 on the running core").arg(profileId));
+        return true;
+    }
+
+    void CoreManager::updateLatency() {
+        if (!isRunning() || m_controller.balancerMembers.isEmpty() || m_latencyReply != nullptr) {
+            return;
+        }
+
+        // answered later on the event loop; a nested loop here would run a switch or stop mid-way
+        auto members = m_controller.balancerMembers;
+        m_latencyReply = sendControllerRequest("GET", "/proxies", {});
+        connect(m_latencyReply, &QNetworkReply::finished, this, [this, members]() {
+            auto reply = m_latencyReply;
+            m_latencyReply = nullptr;
+            reply->deleteLater();
+            if (reply->error() != QNetworkReply::NoError) return;
+
+            auto proxies = QString2QJsonObject(reply->readAll())["proxies"].toObject();
+            for (auto it = members.constBegin(); it != members.constEnd(); ++it) {
+                auto history = proxies[it.key()].toObject()["history"].toArray();
+                auto ent = NekoGui::profileManager->GetProfile(it.value());
+                if (history.isEmpty() || ent == nullptr) continue;
+                auto delay = history.last().toObject()["delay"].toInt();
+                auto latency = delay > 0 ? delay : -1;
+                if (ent->latency == latency) continue;
+                ent->latency = latency;
+                ent->Save();
+                NekoGui_traffic::trafficHistory->AddLatency(ent->id, latency);
+            }
+        });
+    }
+
+    QNetworkReply *CoreManager::sendControllerRequest(const QByteArray &verb, const QString &path, const QByteArray &body) {
+        if (m_network == nullptr) m_network = new QNetworkAccessManager(this);
+        QNetworkRequest request(QUrl(QString("http://%1%2").arg(m_controller.address, path)));
+        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+        if (!m_controller.secret.isEmpty()) {
+            request.setRawHeader("Authorization", "Bearer " + m_controller.secret.toUtf8());
+        }
+        auto reply = m_network->sendCustomRequest(request, verb, body);
+        QTimer::singleShot(2000, reply, &QNetworkReply::abort);
+        return reply;
+    }
+
+    QByteArray CoreManager::controllerRequest(const QByteArray &verb, const QString &path, const QByteArray &body, QString *error) {
+        // blocking on the socket, without an event loop: select runs inside control socket
+        // and web API handlers, a nested loop would let the next request in mid-way
+        auto separator = m_controller.address.lastIndexOf(':');
+        auto host = m_controller.address.left(separator);
+        if (host.isEmpty() || host == "0.0.0.0") host = "127.0.0.1"; // a user controller on every address
+        auto port = m_controller.address.mid(separator + 1).toUShort();
+
+        QByteArray request = verb + " " + path.toUtf8() + " HTTP/1.1\r\n" +
+                             "Host: " + m_controller.address.toUtf8() + "\r\n" +
+                             "Content-Type: application/json\r\n" +
+                             "Content-Length: " + QByteArray::number(body.size()) + "\r\n" +
+                             "Connection: close\r\n";
+        if (!m_controller.secret.isEmpty()) request += "Authorization: Bearer " + m_controller.secret.toUtf8() + "\r\n";
+        request += "\r\n" + body;
+
+        constexpr int timeoutMs = 2000;
+        QElapsedTimer timer;
+        timer.start();
+        auto left = [&] { return int(qMax<qint64>(0, timeoutMs - timer.elapsed())); };
+
+        QTcpSocket socket;
+        socket.connectToHost(host, port);
+        if (!socket.waitForConnected(left())) {
+            *error = socket.errorString();
+            return {};
+        }
+        socket.write(request);
+        QByteArray response;
+        // done at Content-Length, or when the controller closes the connection
+        auto complete = [&] {
+            auto end = response.indexOf("\r\n\r\n");
+            if (end < 0) return false;
+            for (const auto &line: response.left(end).split('\n')) {
+                if (line.toLower().startsWith("content-length:")) {
+                    return response.size() - end - 4 >= line.mid(15).trimmed().toLongLong();
+                }
+            }
+            return false;
+        };
+        while (!complete() && socket.state() == QAbstractSocket::ConnectedState && left() > 0) {
+            if (socket.bytesToWrite() > 0) socket.waitForBytesWritten(left());
+            if (socket.waitForReadyRead(left())) response += socket.readAll();
         }
+        response += socket.readAll();
 
-        m_process->deleteLater();
+        auto headerEnd = response.indexOf("\r\n\r\n");
+        if (headerEnd < 0) {
+            *error = socket.state() == QAbstractSocket::ConnectedState ? "controller timeout" : "no response from the controller";
+            return {};
+        }
+        // "HTTP/1.1 204 No Content"
+        auto status = response.left(response.indexOf("\r\n")).split(' ').value(1).toInt();
+        auto data = response.mid(headerEnd + 4);
+        *error = status >= 200 && status < 300 ? QString() : QString("controller returned %1: %2").arg(status).arg(QString::fromUtf8(data));
+        return data;
+    }
+
+    bool CoreManager::stop() {
+        while (!m_draining.isEmpty()) {
+            terminateCore(m_draining.takeFirst());
+        }
+
+        if (!m_process || m_process->state() == QProcess::NotRunning) {
+            return true;
+        }
+
+        terminateCore(m_process);
         m_process = nullptr;
+        m_controller = {};
+        m_servePorts.clear();
         m_currentProfileId = -1;
 
         emit logOutput("Core process stopped");
         return true;
     }
 
+    QProcess *CoreManager::spawnCore() {
+        auto process = new QProcess(this);
+        connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
+                    // a draining core exiting is expected
+                    if (process == m_process) emit processFinished(exitCode, exitStatus);
+                });
+        connect(process, &QProcess::readyReadStandardOutput,
+                this, &CoreManager::onReadyReadStandardOutput);
+        connect(process, &QProcess::readyReadStandardError,
+                this, &CoreManager::onReadyReadStandardError);
+
+        QStringList arguments;
+        arguments << "run-managed" << "-c" << m_configPath;
+
+        m_coreStarted = false;
+        process->start(m_corePath, arguments);
+
+        if (!process->waitForStarted(5000)) {
+            qWarning() << "Failed to start core process:" << process->errorString();
+            process->deleteLater();
+            return nullptr;
+        }
+        return process;
+    }
+
+    void CoreManager::terminateCore(QProcess *process) {
+        process->terminate();
+        if (!process->waitForFinished(5000)) {
+            process->kill();
+            process->waitForFinished(2000);
+        }
+        process->deleteLater();
+    }
+
     bool CoreManager::isRunning() const {
         return m_process && m_process->state() == QProcess::Running;
     }
 
+    bool CoreManager::waitForReady(int timeoutMs) {
+        // the core reports ready once every inbound listens; probing the mixed inbound is
+        // quicker, but while an old core is draining it answers on the same port
+        auto port = m_servePorts.isEmpty() ? NekoGui::dataStore->inbound_socks_port : m_servePorts.lastKey();
+        auto probePort = IsValidPort(port) && m_draining.isEmpty();
+
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < timeoutMs) {
+            if (!isRunning()) return false;
+            if (m_coreStarted) return true;
+            if (probePort && ProbeTcpPort(NekoGui::dataStore->inbound_address, port)) return true;
+            if (!probePort && !IsValidPort(port)) return true;
+            m_process->waitForReadyRead(20);
+        }
+        qWarning() << "Core did not become ready within" << timeoutMs << "ms";
+        return false;
+    }
+
     int CoreManager::getProcessId() const {
         if (m_process && m_process->state() == QProcess::Running) {
             return m_process->processId();
@@ -113,8 +367,11 @@ namespace NekoCore {
     }
 
     void CoreManager::onReadyReadStandardOutput() {
-        if (m_process) {
-            QByteArray data = m_process->readAllStandardOutput();
+        auto process = qobject_cast<QProcess *>(sender());
+        if (process) {
+            QByteArray data = process->readAllStandardOutput();
+            // printed by run-managed whatever the log level
+            if (process == m_process && data.contains("nekobox_core: ready")) m_coreStarted = true;
             QStringList lines = QString::fromUtf8(data).split('\n', Qt::SkipEmptyParts);
             for (const QString &line : lines) {
                 emit logOutput(line.trimmed());
@@ -123,8 +380,9 @@ namespace NekoCore {
     }
 
     void CoreManager::onReadyReadStandardError() {
-        if (m_process) {
-            QByteArray data = m_process->readAllStandardError();
+        auto process = qobject_cast<QProcess *>(sender());
+        if (process) {
+            QByteArray data = process->readAllStandardError();
             QStringList lines = QString::fromUtf8(data).split('\n', Qt::SkipEmptyParts);
             for (const QString &line : lines) {
                 emit logOutput("[ERROR] " + line.trimmed());
@@ -139,26 +397,77 @@ namespace NekoCore {
             return false;
         }
 
-        // Build configuration using existing ConfigBuilder
-        NekoGui::BuildConfigStatus status;
-        status.ent = profile;
-        status.result = std::make_shared<NekoGui::BuildConfigResult>();
+        // a restart with unchanged inputs hands the cached config to the core
+        NekoGui::ConfigCache::Entry built;
+        QJsonObject coreConfig;
+        if (!NekoGui::configCache->Get(profileId, {}, built)) {
+            // Build configuration using existing ConfigBuilder
+            auto result = NekoGui::BuildConfig(profile, false, false);
+            if (!result->error.isEmpty()) {
+                qWarning() << "Failed to build config for profile:" << profileId << result->error;
+                return false;
+            }
+            coreConfig = result->coreConfig;
+            if (NekoGui::dataStore->core_switch_overlap) {
+                // let a second core bind the same ports during a switch (SO_REUSEADDR + SO_REUSEPORT)
+                auto inbounds = coreConfig["inbounds"].toArray();
+                for (int i = 0; i < inbounds.size(); i++) {
+                    auto inbound = inbounds[i].toObject();
+                    if (!inbound.contains("listen_port")) continue;
+                    inbound["reuse_addr"] = true;
+                    inbounds[i] = inbound;
+                }
+                coreConfig["inbounds"] = inbounds;
+            }
+            built = {NekoGui::configCache->Put(profileId, {}, *result, coreConfig), result->selectorMembers,
+                     result->balancerTags, result->balancerMembers, result->ruleConflicts};
+        }
+        if (!built.ruleConflicts.isEmpty()) {
+            qWarning() << "Routing entries shadowed by an earlier list:" << built.ruleConflicts.size();
+            for (const auto &conflict: built.ruleConflicts) qDebug() << " " << conflict;
+        }
+
+        m_controller = {};
+        bool privateController = false;
+        if (!built.selectorMembers.isEmpty() || !built.balancerTags.isEmpty()) {
+            if (coreConfig.isEmpty()) coreConfig = QString2QJsonObject(ReadFileText(built.path));
+            m_controller.selectorMembers = built.selectorMembers;
+            m_controller.balancerMembers = built.balancerMembers;
+            auto experimental = coreConfig["experimental"].toObject();
+            auto clashApi = experimental["clash_api"].toObject();
+            if (clashApi.isEmpty()) {
+                // no user controller, open a private one on loopback
+                m_controller.lease = NekoGui_sys::portPool->Lease();
+                auto port = m_controller.lease ? m_controller.lease->port : MkPort();
+                m_controller.secret = GetRandomString(16);
+                clashApi["external_controller"] = "127.0.0.1:" + Int2String(port);
+                clashApi["secret"] = m_controller.secret;
+                experimental["clash_api"] = clashApi;
+                coreConfig["experimental"] = experimental;
+                privateController = true;
+            } else {
+                m_controller.secret = clashApi["secret"].toString();
+            }
+            m_controller.address = clashApi["external_controller"].toString();
+        }
 
-        auto core_box = NekoGui::BuildConfig(profile, false);
-        if (core_box.isEmpty()) {
-            qWarning() << "Failed to build config for profile:" << profileId;
-            return false;
+        // the port and secret of a private controller change every run, the rest stays cached
+        if (built.path.isEmpty() || privateController) {
+            return writeConfig(coreConfig, QString::number(profileId));
         }
+        m_configPath = built.path;
+        return true;
+    }
 
-        // Write config to file
-        m_configPath = QDir::temp().absoluteFilePath(QString("nekoray_core_%1.json").arg(profileId));
+    bool CoreManager::writeConfig(const QJsonObject &coreConfig, const QString &name) {
+        m_configPath = QDir::temp().absoluteFilePath(QString("nekoray_core_%1.json").arg(name));
         QFile file(m_configPath);
         if (!file.open(QIODevice::WriteOnly)) {
             qWarning() << "Failed to write config file:" << m_configPath;
             return false;
         }
 
-        file.write(core_box.toUtf8());
+        file.write(QJsonObject2QString(coreConfig, false).toUtf8());
         file.close();
 
         return true;
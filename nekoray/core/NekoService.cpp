@@ -140,6 +140,13 @@ namespace NekoCore {
             return false;
         }
 
+        if (!m_coreManager->waitForReady(10000)) {
+            m_coreManager->stop();
+            setStatus(ServiceStatus::Error);
+            emit errorOccurred("Core process did not become ready");
+            return false;
+        }
+
         // Start TUN mode if enabled
         if (NekoGui::dataStore->spmode_vpn && NekoGui::dataStore->vpn_internal_tun) {
             if (!m_tunManager->start()) {
@@ -183,13 +190,71 @@ namespace NekoCore {
         if (!stopProxy()) {
             return false;
         }
-        
-        // Give some time for processes to fully stop
-        QThread::msleep(500);
-        
+
+        // stop() waits for the process to exit, startProxy() waits for the new one to listen
         return startProxy();
     }
 
+    bool NekoService::switchProfile(int profileId) {
+        if (m_status != ServiceStatus::Running) {
+            return loadProfile(profileId) && startProxy();
+        }
+        if (NekoGui::profileManager->GetProfile(profileId) == nullptr) {
+            emit errorOccurred(QString("Profile %1 not found").arg(profileId));
+            return false;
+        }
+
+        // the profile is behind the running selector, nothing to rebuild
+        if (m_coreManager->select(profileId)) {
+            loadProfile(profileId);
+            emit logMessage("info", QString("Switched to profile %1").arg(profileId));
+            return true;
+        }
+
+        if (!NekoGui::dataStore->core_switch_overlap) {
+            return loadProfile(profileId) && restartProxy();
+        }
+
+        // blue/green: the old core keeps serving until the new one is healthy,
+        // the current profile only changes once it is
+        {
+            QMutexLocker locker(&m_mutex);
+            if (!m_coreManager->switchTo(profileId, NekoGui::dataStore->core_switch_grace)) {
+                emit errorOccurred("Failed to switch core, still running the previous profile");
+                return false;
+            }
+        }
+        loadProfile(profileId);
+        emit logMessage("info", QString("Switched to profile %1").arg(profileId));
+        return true;
+    }
+
+    bool NekoService::serve(const QMap<int, int> &servePorts) {
+        if (!stopProxy()) {
+            return false;
+        }
+
+        QMutexLocker locker(&m_mutex);
+        setStatus(ServiceStatus::Starting);
+
+        if (!m_coreManager->serve(servePorts) || !m_coreManager->waitForReady(10000)) {
+            m_coreManager->stop();
+            setStatus(ServiceStatus::Error);
+            emit errorOccurred("Failed to start serving");
+            return false;
+        }
+
+        m_currentProfileId = -1;
+        m_trafficTimer->start();
+        setStatus(ServiceStatus::Running);
+        emit logMessage("info", QString("Serving %1 profiles").arg(servePorts.size()));
+        return true;
+    }
+
+    QMap<int, int> NekoService::getServePorts() const {
+        return m_coreManager->servePorts();
+    }
+
     bool NekoService::startTunMode() {
         QMutexLocker locker(&m_mutex);
         
@@ -289,6 +354,11 @@ namespace NekoCore {
             m_uploadBytes += qrand() % 1000;
             m_downloadBytes += qrand() % 5000;
             emit trafficUpdated(m_uploadBytes, m_downloadBytes);
+
+            // balancer probe results back into ProxyEntity::latency
+            if (++m_trafficTicks % 5 == 0) {
+                m_coreManager->updateLatency();
+            }
         }
     }
 
@@ -5,7 +5,16 @@
 #include <QTimer>
 #include <QJsonObject>
 #include <QMutex>
+#include <QMap>
 #include <QSharedPointer>
+#include <memory>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+namespace NekoGui_sys {
+    class PortLease;
+}
 
 namespace NekoCore {
 
@@ -50,6 +59,11 @@ namespace NekoCore {
         bool startProxy();
         bool stopProxy();
         bool restartProxy();
+        bool switchProfile(int profileId);
+
+        // Serving mode: several profiles at once, each on its own port (port -> profile id), in one core
+        bool serve(const QMap<int, int> &servePorts);
+        QMap<int, int> getServePorts() const;
         
         // TUN mode
         bool startTunMode();
@@ -110,6 +124,7 @@ namespace NekoCore {
         qint64 m_downloadBytes;
         qint64 m_lastUploadBytes;
         qint64 m_lastDownloadBytes;
+        int m_trafficTicks = 0;
     };
 
     // Core process manager
@@ -121,10 +136,16 @@ namespace NekoCore {
         ~CoreManager();
 
         bool start(int profileId);
+        bool switchTo(int profileId, int graceSeconds);
+        bool serve(const QMap<int, int> &servePorts);
+        bool select(int profileId);
+        void updateLatency(); // async, results land in ProxyEntity::latency
         bool stop();
         bool isRunning() const;
+        bool waitForReady(int timeoutMs);
         QString getConfigPath() const { return m_configPath; }
         int getProcessId() const;
+        QMap<int, int> servePorts() const { return m_servePorts; }
 
     signals:
         void processFinished(int exitCode, QProcess::ExitStatus exitStatus);
@@ -136,8 +157,29 @@ namespace NekoCore {
 
     private:
         bool generateConfig(int profileId);
+        bool writeConfig(const QJsonObject &coreConfig, const QString &name);
+        QProcess *spawnCore();
+        void terminateCore(QProcess *process);
+
+        QNetworkReply *sendControllerRequest(const QByteArray &verb, const QString &path, const QByteArray &body);
+        QByteArray controllerRequest(const QByteArray &verb, const QString &path, const QByteArray &body, QString *error);
+
+        // clash API of the running core, drives the "proxy" selector and reads urltest results
+        struct Controller {
+            QMap<int, QString> selectorMembers; // profile id -> outbound tag
+            QMap<QString, int> balancerMembers; // outbound tag -> profile id
+            QString address;
+            QString secret;
+            std::shared_ptr<NekoGui_sys::PortLease> lease;
+        };
 
         QProcess *m_process;
+        Controller m_controller;
+        QNetworkAccessManager *m_network = nullptr;
+        QNetworkReply *m_latencyReply = nullptr; // the balancer poll in flight
+        QList<QProcess *> m_draining; // old cores serving their open connections after a switch
+        bool m_coreStarted = false;
+        QMap<int, int> m_servePorts;
         QString m_configPath;
         QString m_corePath;
         int m_currentProfileId;
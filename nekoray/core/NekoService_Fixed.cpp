@@ -147,7 +147,7 @@ namespace NekoCore {
         bool vpnInternalTun = m_currentConfig.value("vpn_internal_tun").toBool();
         
         if (spModeVpn && vpnInternalTun) {
-            if (!m_tunManager->start()) {
+            if (!(m_tunManager->isRunning() ? m_tunManager->reconfigure() : m_tunManager->start())) {
                 emit logMessage("warn", "Failed to start TUN mode, continuing without TUN");
             }
         }
@@ -7,6 +7,8 @@
 #include <QMutex>
 #include <QSharedPointer>
 
+class TunHelperClient;
+
 namespace NekoCore {
 
     // Service status
@@ -159,6 +161,7 @@ namespace NekoCore {
 
         bool start();
         bool stop();
+        bool reconfigure(); // restart the TUN core with a fresh config
         bool isRunning() const;
         QString getTunConfigPath() const { return m_tunConfigPath; }
 
@@ -173,12 +176,19 @@ namespace NekoCore {
 
     private:
         bool generateTunConfig();
+        bool generateTunScript();
         bool startTunProcess();
+        bool startWithHelper(const QString &command);
 
         QProcess *m_tunProcess;
         QString m_tunConfigPath;
         QString m_tunScriptPath;
         QString m_corePath;
+
+        // resident privileged helper (Linux), falls back to pkexec when unavailable
+        TunHelperClient *m_helper;
+        bool m_helperFailed;
+        bool m_helperCore;
     };
 
     // Configuration manager
@@ -9,11 +9,18 @@
 #include <QJsonDocument>
 #include <QJsonArray>
 
+#ifdef Q_OS_LINUX
+#include "../sys/linux/TunHelper.hpp"
+#endif
+
 namespace NekoCore {
 
     TunManager::TunManager(QObject *parent)
         : QObject(parent)
         , m_tunProcess(nullptr)
+        , m_helper(nullptr)
+        , m_helperFailed(false)
+        , m_helperCore(false)
     {
         // Find core executable for TUN mode
         QString appDir = QCoreApplication::applicationDirPath();
@@ -32,7 +39,7 @@ namespace NekoCore {
     }
 
     TunManager::~TunManager() {
-        if (m_tunProcess) {
+        if (isRunning()) {
             stop();
         }
     }
@@ -42,7 +49,7 @@ namespace NekoCore {
     }
 
     bool TunManager::start() {
-        if (m_tunProcess && m_tunProcess->state() != QProcess::NotRunning) {
+        if (m_helperCore || (m_tunProcess && m_tunProcess->state() != QProcess::NotRunning)) {
             return true; // Already running
         }
 
@@ -56,10 +63,41 @@ namespace NekoCore {
             return false;
         }
 
+        if (startWithHelper("start")) {
+            return true;
+        }
+
         return startTunProcess();
     }
 
+    bool TunManager::reconfigure() {
+        if (!m_helperCore) {
+            stop();
+            return start();
+        }
+
+        if (!generateTunConfig()) {
+            qWarning() << "Failed to generate TUN config";
+            return false;
+        }
+
+        return startWithHelper("reconfigure");
+    }
+
     bool TunManager::stop() {
+        if (m_helperCore) {
+            m_helperCore = false;
+#ifdef Q_OS_LINUX
+            QString error;
+            if (!m_helper->Command("stop", {}, &error)) {
+                qWarning() << "TUN helper failed to stop:" << error;
+            }
+#endif
+            QFile::remove(m_tunConfigPath);
+            emit logOutput("TUN process stopped");
+            return true;
+        }
+
         if (!m_tunProcess || m_tunProcess->state() == QProcess::NotRunning) {
             return true;
         }
@@ -94,7 +132,7 @@ namespace NekoCore {
     }
 
     bool TunManager::isRunning() const {
-        return m_tunProcess && m_tunProcess->state() == QProcess::Running;
+        return m_helperCore || (m_tunProcess && m_tunProcess->state() == QProcess::Running);
     }
 
     void TunManager::onReadyReadStandardOutput() {
@@ -232,24 +270,67 @@ namespace NekoCore {
         file.write(doc.toJson());
         file.close();
 
+        qDebug() << "Generated TUN config at:" << m_tunConfigPath;
+        return true;
+    }
+
+    bool TunManager::generateTunScript() {
 #ifndef Q_OS_WIN
         // Generate script for Linux/macOS privilege escalation
         m_tunScriptPath = QDir::temp().absoluteFilePath("nekoray_tun.sh");
         QFile scriptFile(m_tunScriptPath);
-        if (scriptFile.open(QIODevice::WriteOnly)) {
-            QTextStream stream(&scriptFile);
-            stream << "#!/bin/bash\n";
-            stream << "echo \"Starting NekoRay TUN mode...\"\n";
-            stream << "exec \"" << m_corePath << "\" --disable-color run -c \"" << m_tunConfigPath << "\"\n";
-            scriptFile.close();
-            
-            // Make script executable
-            QProcess::execute("chmod", {"+x", m_tunScriptPath});
+        if (!scriptFile.open(QIODevice::WriteOnly)) {
+            return false;
         }
+        QTextStream stream(&scriptFile);
+        stream << "#!/bin/bash\n";
+        stream << "echo \"Starting NekoRay TUN mode...\"\n";
+        stream << "exec \"" << m_corePath << "\" --disable-color run -c \"" << m_tunConfigPath << "\"\n";
+        scriptFile.close();
+
+        // Make script executable
+        scriptFile.setPermissions(scriptFile.permissions() | QFileDevice::ExeOwner);
 #endif
+        return true;
+    }
 
-        qDebug() << "Generated TUN config at:" << m_tunConfigPath;
+    bool TunManager::startWithHelper(const QString &command) {
+#ifdef Q_OS_LINUX
+        if (m_helperFailed) {
+            return false;
+        }
+
+        if (m_helper == nullptr) {
+            m_helper = new TunHelperClient(this);
+            connect(m_helper, &TunHelperClient::logOutput, this, [this](const QString &line) {
+                emit logOutput("[TUN] " + line);
+            });
+            connect(m_helper, &TunHelperClient::coreFinished, this, [this](int exitCode) {
+                m_helperCore = false;
+                emit processFinished(exitCode, QProcess::NormalExit);
+            });
+        }
+
+        // started once, later toggles are a socket round-trip
+        if (!m_helper->Connect()) {
+            m_helperFailed = true;
+            emit logOutput("TUN helper unavailable, using pkexec");
+            return false;
+        }
+
+        QString error;
+        if (!m_helper->Command(command, m_tunConfigPath, &error)) {
+            qWarning() << "TUN helper failed to" << command << ":" << error;
+            return false;
+        }
+
+        m_helperCore = true;
+        emit logOutput("TUN process started by the helper");
         return true;
+#else
+        Q_UNUSED(command)
+        return false;
+#endif
     }
 
     bool TunManager::startTunProcess() {
@@ -273,6 +354,9 @@ namespace NekoCore {
         m_tunProcess->start(program, arguments);
 #else
         // Linux/macOS: Use script with pkexec/osascript for privilege escalation
+        if (!generateTunScript()) {
+            qWarning() << "Failed to write TUN script:" << m_tunScriptPath;
+        }
 #ifdef Q_OS_MACOS
         program = "osascript";
         arguments << "-e" << QString("do shell script \"bash %1\" with administrator privileges")
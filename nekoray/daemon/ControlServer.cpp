@@ -0,0 +1,161 @@
+#include "ControlServer.hpp"
+
+#include "../core/ControlSocket.hpp"
+#include "../core/NekoService.hpp"
+#include "../db/Database.hpp"
+
+#include <QCborArray>
+#include <QJsonObject>
+#include <QLocalSocket>
+
+#include <memory>
+
+#ifdef Q_OS_LINUX
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace NekoCore {
+
+    namespace {
+        bool samePeerUser(QLocalSocket *socket) {
+#ifdef Q_OS_LINUX
+            ucred cred{};
+            socklen_t len = sizeof(cred);
+            if (getsockopt((int) socket->socketDescriptor(), SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+            return cred.uid == getuid();
+#else
+            Q_UNUSED(socket)
+            return true;
+#endif
+        }
+
+        QCborMap error(const QString &message) {
+            QCborMap reply;
+            reply[QStringLiteral("ok")] = false;
+            reply[QStringLiteral("error")] = message;
+            return reply;
+        }
+
+        bool profileArg(const QCborArray &args, int &id) {
+            bool ok = false;
+            if (!args.isEmpty()) id = args[0].toString().toInt(&ok);
+            return ok;
+        }
+    } // namespace
+
+    ControlServer::ControlServer(NekoService *service, QObject *parent) : QObject(parent), m_service(service) {}
+
+    bool ControlServer::Listen(const QString &path) {
+        m_server.setSocketOptions(QLocalServer::UserAccessOption);
+        QLocalServer::removeServer(path);
+        connect(&m_server, &QLocalServer::newConnection, this, &ControlServer::onNewConnection);
+        return m_server.listen(path);
+    }
+
+    void ControlServer::Close() {
+        auto path = m_server.fullServerName();
+        m_server.close();
+        if (!path.isEmpty()) QLocalServer::removeServer(path);
+    }
+
+    void ControlServer::onNewConnection() {
+        while (auto socket = m_server.nextPendingConnection()) {
+            if (!samePeerUser(socket)) {
+                socket->abort();
+                socket->deleteLater();
+                continue;
+            }
+            auto buffer = std::make_shared<QByteArray>();
+            connect(socket, &QLocalSocket::disconnected, socket, &QObject::deleteLater);
+            connect(socket, &QLocalSocket::readyRead, this, [=] {
+                *buffer += socket->readAll();
+                QCborMap request;
+                bool bad;
+                while (Control::Unframe(*buffer, request, bad)) {
+                    socket->write(Control::Frame(handle(request)));
+                }
+                if (bad) socket->abort();
+            });
+        }
+    }
+
+    QCborMap ControlServer::proxyInfo() {
+        QCborMap reply;
+        reply[QStringLiteral("ok")] = true;
+        reply[QStringLiteral("socks")] = m_service->getSocksAddress();
+        reply[QStringLiteral("socks_port")] = m_service->getSocksPort();
+        reply[QStringLiteral("http")] = m_service->getHttpAddress();
+        reply[QStringLiteral("http_port")] = m_service->getHttpPort();
+        return reply;
+    }
+
+    QCborMap ControlServer::handle(const QCborMap &request) {
+        auto cmd = request.value(QStringLiteral("cmd")).toString();
+        auto args = request.value(QStringLiteral("args")).toArray();
+
+        // the service reports why an operation failed through errorOccurred
+        QString lastError;
+        auto connection = connect(m_service, &NekoService::errorOccurred, this, [&](const QString &e) { lastError = e; });
+        auto failed = [&](const QString &what) {
+            return error(lastError.isEmpty() ? what : what + ": " + lastError);
+        };
+
+        QCborMap reply;
+        if (cmd == "status") {
+            reply = proxyInfo();
+            reply[QStringLiteral("status")] = m_service->getStatusString();
+            reply[QStringLiteral("running")] = m_service->getStatus() == ServiceStatus::Running;
+            reply[QStringLiteral("profile")] = m_service->getCurrentProfileId();
+            reply[QStringLiteral("tun")] = m_service->isTunModeRunning();
+            reply[QStringLiteral("upload")] = m_service->getUploadBytes();
+            reply[QStringLiteral("download")] = m_service->getDownloadBytes();
+        } else if (cmd == "list" || cmd == "search") {
+            QList<int> ids;
+            if (cmd == "list") {
+                auto table = NekoGui::profileManager->Profiles();
+                for (const auto &[id, _]: table->profiles) ids << id;
+            } else {
+                QStringList words;
+                for (const auto &arg: args) words << arg.toString();
+                ids = NekoGui::profileManager->SearchProfiles(words.join(' '), request.value(QStringLiteral("fuzzy")).toBool());
+            }
+            // rows of [id, type, address, name]
+            QCborArray profiles;
+            for (auto id: ids) {
+                auto ent = NekoGui::profileManager->GetProfile(id);
+                if (ent == nullptr) continue;
+                profiles.append(QCborArray{id, ent->meta.type, ent->meta.address, ent->meta.name});
+            }
+            reply[QStringLiteral("ok")] = true;
+            reply[QStringLiteral("profiles")] = profiles;
+        } else if (cmd == "start" || cmd == "restart") {
+            int id;
+            if (!profileArg(args, id)) {
+                reply = error("invalid profile ID");
+            } else if (NekoGui::profileManager->GetProfile(id) == nullptr) {
+                reply = error(QString("profile %1 not found").arg(id));
+            } else {
+                // as the web API does: a running core is switched over, not left on the old profile
+                bool alreadyRunning = cmd == "start" && m_service->getStatus() == ServiceStatus::Running &&
+                                      m_service->getCurrentProfileId() == id;
+                reply = alreadyRunning || m_service->switchProfile(id) ? proxyInfo() : failed("failed to " + cmd + " proxy");
+            }
+        } else if (cmd == "stop") {
+            reply = m_service->stopProxy() ? proxyInfo() : failed("failed to stop proxy");
+        } else if (cmd == "tun-start") {
+            reply = m_service->startTunMode() ? proxyInfo() : failed("failed to start TUN mode");
+        } else if (cmd == "tun-stop") {
+            reply = m_service->stopTunMode() ? proxyInfo() : failed("failed to stop TUN mode");
+        } else if (cmd == "config") {
+            reply[QStringLiteral("ok")] = true;
+            reply[QStringLiteral("config")] = QCborMap::fromJsonObject(m_service->getCurrentConfig());
+        } else {
+            reply = error("unknown command: " + cmd);
+        }
+
+        disconnect(connection);
+        return reply;
+    }
+
+} // namespace NekoCore
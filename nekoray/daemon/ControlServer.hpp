@@ -0,0 +1,30 @@
+#pragma once
+
+#include <QCborMap>
+#include <QLocalServer>
+
+namespace NekoCore {
+
+    class NekoService;
+
+    // Serves nekoray-cli on the control socket, see core/ControlSocket.hpp.
+    class ControlServer : public QObject {
+    public:
+        explicit ControlServer(NekoService *service, QObject *parent = nullptr);
+
+        bool Listen(const QString &path);
+
+        void Close();
+
+    private:
+        NekoService *m_service;
+        QLocalServer m_server;
+
+        void onNewConnection();
+
+        QCborMap handle(const QCborMap &request);
+
+        QCborMap proxyInfo();
+    };
+
+} // namespace NekoCore
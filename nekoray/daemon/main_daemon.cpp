@@ -6,9 +6,13 @@
 #include <QTextStream>
 #include <QSignalMapper>
 #include <QThread>
+#include <QDir>
 
+#include "../core/ControlSocket.hpp"
 #include "../core/NekoService.hpp"
+#include "../db/Database.hpp"
 #include "../web/WebApiServer.hpp"
+#include "ControlServer.hpp"
 
 #include <csignal>
 
@@ -26,6 +30,7 @@ public:
         
         m_service = nullptr;
         m_webServer = nullptr;
+        m_controlServer = nullptr;
     }
 
     static void signalHandler(int signal) {
@@ -82,6 +87,10 @@ public:
         connect(m_service, &NekoCore::NekoService::statusChanged,
                 this, &DaemonApplication::onStatusChanged);
 
+        // Profiles are loaded once here and shared by the web API and CLI clients
+        QDir::setCurrent(m_service->getConfigDir());
+        NekoGui::profileManager->LoadManager();
+
         // Initialize web server
         m_webServer = new NekoWeb::WebApiServer(this);
         int webPort = parser.value(portOption).toInt();
@@ -91,28 +100,34 @@ public:
             return 1;
         }
 
+        // nekoray-cli talks to this daemon instead of starting its own core
+        auto controlPath = NekoCore::Control::SocketPath(configDir);
+        m_controlServer = new NekoCore::ControlServer(m_service, this);
+        if (!m_controlServer->Listen(controlPath)) {
+            qWarning() << "Failed to listen on control socket" << controlPath;
+        }
+
         QTextStream out(stdout);
         out << "NekoRay Daemon started successfully" << Qt::endl;
         out << "Web interface: http://localhost:" << webPort << Qt::endl;
         out << "Configuration directory: " << (configDir.isEmpty() ? "default" : configDir) << Qt::endl;
 
-        // Auto-start proxy if requested
+        // Auto-start proxy and TUN once the event loop runs. startProxy() only returns
+        // after the core listens, so TUN can follow it directly.
+        int autoStartProfileId = -1;
         if (parser.isSet(autoStartOption)) {
             bool ok;
-            int profileId = parser.value(autoStartOption).toInt(&ok);
-            if (ok) {
-                QTimer::singleShot(1000, [this, profileId]() {
-                    autoStartProxy(profileId);
-                });
-            } else {
+            autoStartProfileId = parser.value(autoStartOption).toInt(&ok);
+            if (!ok) {
+                autoStartProfileId = -1;
                 qWarning() << "Invalid profile ID for auto-start:" << parser.value(autoStartOption);
             }
         }
-
-        // Auto-start TUN if requested
-        if (parser.isSet(tunOption)) {
-            QTimer::singleShot(2000, [this]() {
-                autoStartTun();
+        bool autoStartTunMode = parser.isSet(tunOption);
+        if (autoStartProfileId >= 0 || autoStartTunMode) {
+            QTimer::singleShot(0, this, [this, autoStartProfileId, autoStartTunMode]() {
+                if (autoStartProfileId >= 0) autoStartProxy(autoStartProfileId);
+                if (autoStartTunMode) autoStartTun();
             });
         }
 
@@ -188,6 +203,10 @@ private slots:
         QTextStream out(stdout);
         out << "Shutting down daemon..." << Qt::endl;
 
+        if (m_controlServer) {
+            m_controlServer->Close();
+        }
+
         if (m_service) {
             m_service->shutdown();
         }
@@ -202,6 +221,7 @@ private slots:
 private:
     NekoCore::NekoService *m_service;
     NekoWeb::WebApiServer *m_webServer;
+    NekoCore::ControlServer *m_controlServer;
     bool m_verbose = false;
 };
 
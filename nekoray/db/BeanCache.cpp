@@ -0,0 +1,98 @@
+#include "BeanCache.hpp"
+#include "Database.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonDocument>
+
+namespace NekoGui {
+
+    std::shared_ptr<NekoGui_fmt::AbstractBean> BeanCache::Get(ProxyEntity *ent) {
+        QMutexLocker locker(&mutex);
+        // another thread may have loaded it meanwhile
+        auto bean = std::atomic_load(&ent->bean.bean);
+        if (bean != nullptr) return bean;
+        if (ent->fn.isEmpty()) return nullptr; // no bean at all
+
+        bean = load(ent, touch(ent));
+        if (used > budget) trim();
+        return bean;
+    }
+
+    void BeanCache::Saved(ProxyEntity *ent, const QByteArray &beanJson) {
+        if (ent->fn.isEmpty()) return;
+        QMutexLocker locker(&mutex);
+        auto &entry = touch(ent);
+        used += beanJson.size() - entry.cost;
+        entry.cost = beanJson.size();
+        entry.savedHash = qHash(beanJson);
+        entry.saved = true;
+        if (used > budget) trim();
+    }
+
+    void BeanCache::Forget(ProxyEntity *ent) {
+        QMutexLocker locker(&mutex);
+        auto it = entries.find(ent);
+        if (it == entries.end()) return;
+        used -= (*it)->cost;
+        lru.erase(*it);
+        entries.erase(it);
+    }
+
+    BeanCache::Entry &BeanCache::touch(ProxyEntity *ent) {
+        auto it = entries.find(ent);
+        if (it == entries.end()) {
+            lru.push_front(Entry{ent});
+            it = entries.insert(ent, lru.begin());
+        } else {
+            lru.splice(lru.begin(), lru, *it);
+        }
+        return **it;
+    }
+
+    std::shared_ptr<NekoGui_fmt::AbstractBean> BeanCache::load(ProxyEntity *ent, Entry &entry) {
+        auto bean = std::shared_ptr<NekoGui_fmt::AbstractBean>(ProfileManager::NewBean(ent->type));
+        QFile file(ent->fn);
+        if (file.open(QIODevice::ReadOnly)) {
+            bean->FromJson(QJsonDocument::fromJson(file.readAll()).object()["bean"].toObject());
+        } else {
+            qWarning() << "BeanCache: can not open" << ent->fn << file.errorString();
+        }
+        std::atomic_store(&ent->bean.bean, bean);
+
+        // not from disk, never dropped
+        if (!file.isOpen()) return bean;
+        auto json = bean->ToJsonBytes();
+        used += json.size() - entry.cost;
+        entry.cost = json.size();
+        entry.savedHash = qHash(json);
+        entry.saved = true;
+        return bean;
+    }
+
+    void BeanCache::trim() {
+        // each entry is looked at once at most, a referenced one only loses its bit
+        auto it = lru.end();
+        for (auto left = lru.size(); used > budget && left > 0 && it != lru.begin(); left--) {
+            auto current = std::prev(it);
+            auto &ref = current->ent->bean;
+            if (ref.referenced.exchange(false, std::memory_order_relaxed)) {
+                lru.splice(lru.begin(), lru, current);
+                continue;
+            }
+            auto bean = std::atomic_load(&ref.bean);
+            // held by a caller besides the entity and this copy, or changed and not saved yet
+            if (bean == nullptr || !current->saved || bean.use_count() > 2 || qHash(bean->ToJsonBytes()) != current->savedHash) {
+                it = current;
+                continue;
+            }
+
+            // a caller that loads it after this keeps its own reference, nothing dangles
+            std::atomic_store(&ref.bean, std::shared_ptr<NekoGui_fmt::AbstractBean>());
+            used -= current->cost;
+            entries.remove(current->ent);
+            it = lru.erase(current);
+        }
+    }
+
+} // namespace NekoGui
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QMutex>
+#include <list>
+#include <memory>
+
+namespace NekoGui_fmt {
+    class AbstractBean;
+}
+
+namespace NekoGui {
+    class ProxyEntity;
+
+    // Parsed beans of saved profiles, most recently loaded or saved first, kept under a
+    // budget of roughly their serialized size. Over it, the oldest bean is dropped once no
+    // shared_ptr holds it and it has no unsaved change; one used since the last pass gets a
+    // second chance at the front instead. A dropped bean is parsed from the file again.
+    class BeanCache {
+    public:
+        // the slow path of BeanRef::Get, for a bean not loaded yet
+        std::shared_ptr<NekoGui_fmt::AbstractBean> Get(ProxyEntity *ent);
+
+        // beanJson is what is written now, an evicted bean is reloaded from it
+        void Saved(ProxyEntity *ent, const QByteArray &beanJson);
+
+        void Forget(ProxyEntity *ent);
+
+    private:
+        struct Entry {
+            ProxyEntity *ent;
+            qint64 cost = 0;
+            size_t savedHash = 0;
+            bool saved = false;
+        };
+
+        static constexpr qint64 budget = 16 << 20;
+
+        QMutex mutex;
+        std::list<Entry> lru;
+        QHash<ProxyEntity *, std::list<Entry>::iterator> entries;
+        qint64 used = 0;
+
+        // moved to the front, added when missing
+        Entry &touch(ProxyEntity *ent);
+
+        std::shared_ptr<NekoGui_fmt::AbstractBean> load(ProxyEntity *ent, Entry &entry);
+
+        void trim();
+    };
+
+    inline BeanCache *beanCache = new BeanCache;
+} // namespace NekoGui
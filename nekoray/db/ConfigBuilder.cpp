@@ -1,13 +1,16 @@
 #include "db/ConfigBuilder.hpp"
 #include "db/Database.hpp"
+#include "db/RuleMinimizer.hpp"
+#include "db/RuleSetCache.hpp"
 #include "fmt/includes.h"
 #include "fmt/Preset.hpp"
 
 #include <QApplication>
 #include <QFile>
 #include <QFileInfo>
+#include <QSet>
 
-#define BOX_UNDERLYING_DNS dataStore->core_box_underlying_dns.isEmpty() ? "local" : dataStore->core_box_underlying_dns
+#define BOX_UNDERLYING_DNS ds->core_box_underlying_dns.isEmpty() ? "local" : ds->core_box_underlying_dns
 
 namespace NekoGui {
 
@@ -77,8 +80,10 @@ namespace NekoGui {
         status->result = result;
         status->forTest = forTest;
         status->forExport = forExport;
+        status->ds = dataStore->Snapshot();
+        result->inputProfiles << ent->id;
 
-        auto customBean = dynamic_cast<NekoGui_fmt::CustomBean *>(ent->bean.get());
+        auto customBean = std::dynamic_pointer_cast<NekoGui_fmt::CustomBean>(ent->bean.Get());
         if (customBean != nullptr && customBean->core == "internal-full") {
             result->coreConfig = QString2QJsonObject(customBean->config_simple);
         } else {
@@ -91,12 +96,45 @@ namespace NekoGui {
         return result;
     }
 
+    std::shared_ptr<BuildConfigResult> BuildServeConfig(const QMap<int, int> &servePorts) {
+        auto result = std::make_shared<BuildConfigResult>();
+        auto status = std::make_shared<BuildConfigStatus>();
+        status->result = result;
+        status->forTest = false;
+        status->forExport = false;
+        status->servePorts = servePorts;
+        status->ds = dataStore->Snapshot();
+
+        for (auto id: servePorts) {
+            auto ent = profileManager->GetProfile(id);
+            if (ent == nullptr) {
+                result->error = QStringLiteral("serve profile not found: %1").arg(id);
+                return result;
+            }
+            auto customBean = std::dynamic_pointer_cast<NekoGui_fmt::CustomBean>(ent->bean.Get());
+            if (customBean != nullptr && customBean->core == "internal-full") {
+                result->error = QStringLiteral("a full custom config can't be served with others: %1").arg(id);
+                return result;
+            }
+            if (status->ent == nullptr) status->ent = ent;
+        }
+        if (status->ent == nullptr) {
+            result->error = QStringLiteral("nothing to serve");
+            return result;
+        }
+
+        BuildConfigSingBox(status);
+        return result;
+    }
+
     QString BuildChain(int chainId, const std::shared_ptr<BuildConfigStatus> &status) {
+        auto ds = status->ds;
         auto group = profileManager->GetGroup(status->ent->gid);
         if (group == nullptr) {
             status->result->error = QStringLiteral("This profile is not in any group, your data may be corrupted.");
             return {};
         }
+        status->result->inputGroups << group->id;
 
         auto resolveChain = [=](const std::shared_ptr<ProxyEntity> &ent) {
             QList<std::shared_ptr<ProxyEntity>> resolved;
@@ -109,7 +147,7 @@ namespace NekoGui {
                         status->result->error = QStringLiteral("chain missing ent: %1").arg(id);
                         break;
                     }
-                    if (resolved.last()->type == "chain") {
+                    if (resolved.last()->type == "chain" || resolved.last()->type == "balancer") {
                         status->result->error = QStringLiteral("chain in chain is not allowed: %1").arg(id);
                         break;
                     }
@@ -121,58 +159,152 @@ namespace NekoGui {
         };
 
         // Make list
-        auto ents = resolveChain(status->ent);
-        if (!status->result->error.isEmpty()) return {};
+        auto makeEnts = [=](const std::shared_ptr<ProxyEntity> &ent) {
+            auto ents = resolveChain(ent);
+            if (!status->result->error.isEmpty()) return ents;
+
+            if (group->front_proxy_id >= 0) {
+                auto fEnt = profileManager->GetProfile(group->front_proxy_id);
+                if (fEnt == nullptr) {
+                    status->result->error = QStringLiteral("front proxy ent not found.");
+                    return ents;
+                }
+                ents += resolveChain(fEnt);
+            }
+            return ents;
+        };
 
-        if (group->front_proxy_id >= 0) {
-            auto fEnt = profileManager->GetProfile(group->front_proxy_id);
-            if (fEnt == nullptr) {
-                status->result->error = QStringLiteral("front proxy ent not found.");
-                return {};
+        // Build a profile, chain or balancer once, returns its outbound tag
+        // chainId 0 is the main outbound "proxy", others only have to be unique
+        std::function<QString(const std::shared_ptr<ProxyEntity> &, int)> buildEnt;
+        buildEnt = [&](const std::shared_ptr<ProxyEntity> &ent, int entChainId) -> QString {
+            if (status->builtEnts.contains(ent->id)) return status->builtEnts[ent->id];
+            status->result->inputProfiles << ent->id;
+
+            QString tagOut;
+            if (ent->type == "balancer") {
+                auto bean = ent->BalancerBean();
+                status->result->inputGroups << ent->gid;
+                auto balancerGroup = profileManager->GetGroup(ent->gid);
+                auto members = balancerGroup == nullptr ? QList<std::shared_ptr<ProxyEntity>>{} : balancerGroup->ProfilesWithOrder();
+                if (!bean->list.isEmpty()) {
+                    members.clear();
+                    for (auto id: bean->list) {
+                        members += profileManager->GetProfile(id);
+                        if (members.last() == nullptr) {
+                            status->result->error = QStringLiteral("balancer missing ent: %1").arg(id);
+                            return {};
+                        }
+                    }
+                }
+
+                QJsonArray memberTags;
+                for (const auto &member: members) {
+                    if (member->type == "balancer") continue;
+                    if (bean->list.isEmpty() && member->bean->NeedExternal(true) != 0) continue; // don't spawn a core per member
+                    auto memberTag = buildEnt(member, member->id + 1);
+                    if (!status->result->error.isEmpty()) return {};
+                    if (memberTag.isEmpty() || memberTags.contains(memberTag)) continue;
+                    memberTags += memberTag;
+                    status->result->balancerMembers[memberTag] = member->id;
+                }
+                if (memberTags.isEmpty()) {
+                    status->result->error = QStringLiteral("balancer has no usable member: %1").arg(ent->bean->DisplayName());
+                    return {};
+                }
+
+                tagOut = entChainId == 0 ? "proxy" : "b-" + Int2String(ent->id);
+                status->outbounds += QJsonObject{
+                    {"type", "urltest"},
+                    {"tag", tagOut},
+                    {"outbounds", memberTags},
+                    {"url", bean->url.isEmpty() ? ds->test_latency_url : bean->url},
+                    {"interval", Int2String(qMax(bean->interval, 10)) + "s"},
+                    {"tolerance", qMax(bean->tolerance, 0)},
+                };
+                status->result->balancerTags += tagOut;
+
+                ent->traffic_data->id = ent->id;
+                ent->traffic_data->tag = tagOut.toStdString();
+                status->result->outboundStats += ent->traffic_data;
+                if (entChainId == 0) status->result->outboundStat = ent->traffic_data;
+            } else {
+                auto ents = makeEnts(ent);
+                if (!status->result->error.isEmpty()) return {};
+
+                // BuildChain
+                tagOut = BuildChainInternal(entChainId, ents, status);
+                if (!status->result->error.isEmpty()) return {};
+
+                // Chain ent traffic stat
+                if (ents.length() > 1) {
+                    ent->traffic_data->id = ent->id;
+                    ent->traffic_data->tag = tagOut.toStdString();
+                    status->result->outboundStats += ent->traffic_data;
+                }
             }
-            ents += resolveChain(fEnt);
-            if (!status->result->error.isEmpty()) return {};
-        }
 
-        // BuildChain
-        QString chainTagOut = BuildChainInternal(0, ents, status);
+            status->builtEnts[ent->id] = tagOut;
+            return tagOut;
+        };
 
-        // Chain ent traffic stat
-        if (ents.length() > 1) {
+        // Selector mode: every in-core profile of the group behind one selector, switched at runtime
+        if (ds->core_group_selector && !status->forTest && !status->forExport && status->servePorts.isEmpty() &&
+            status->ent->bean->NeedExternal(true) == 0) {
+            QJsonArray memberTags;
+            QSet<QString> emitted; // a tag is listed once, however many members share it
+            for (const auto &member: group->ProfilesWithOrder()) {
+                if (member != status->ent && member->bean->NeedExternal(true) != 0) continue; // don't spawn a core per member
+                auto memberTag = buildEnt(member, member->id + 1);
+                if (!status->result->error.isEmpty()) return {};
+                if (memberTag.isEmpty() || emitted.contains(memberTag)) continue;
+                emitted.insert(memberTag);
+                status->result->selectorMembers[member->id] = memberTag;
+                memberTags += memberTag;
+            }
+            status->outbounds += QJsonObject{
+                {"type", "selector"},
+                {"tag", "proxy"},
+                {"outbounds", memberTags},
+                {"default", status->result->selectorMembers[status->ent->id]},
+            };
+            // stats are counted on the selector
             status->ent->traffic_data->id = status->ent->id;
-            status->ent->traffic_data->tag = chainTagOut.toStdString();
-            status->result->outboundStats += status->ent->traffic_data;
+            status->ent->traffic_data->tag = "proxy";
+            status->result->outboundStat = status->ent->traffic_data;
+            return "proxy";
         }
 
-        return chainTagOut;
+        return buildEnt(status->ent, chainId);
     }
 
-#define DOMAIN_USER_RULE                                                             \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->proxy_domain)) {  \
-        if (dataStore->routing->dns_routing) status->domainListDNSRemote += line;    \
-        status->domainListRemote += line;                                            \
-    }                                                                                \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->direct_domain)) { \
-        if (dataStore->routing->dns_routing) status->domainListDNSDirect += line;    \
-        status->domainListDirect += line;                                            \
-    }                                                                                \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->block_domain)) {  \
-        status->domainListBlock += line;                                             \
+#define DOMAIN_USER_RULE                                                      \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->proxy_domain)) {  \
+        if (ds->routing->dns_routing) status->domainListDNSRemote += line;    \
+        status->domainListRemote += line;                                     \
+    }                                                                         \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->direct_domain)) { \
+        if (ds->routing->dns_routing) status->domainListDNSDirect += line;    \
+        status->domainListDirect += line;                                     \
+    }                                                                         \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->block_domain)) {  \
+        status->domainListBlock += line;                                      \
     }
 
-#define IP_USER_RULE                                                             \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->block_ip)) {  \
-        status->ipListBlock += line;                                             \
-    }                                                                            \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->proxy_ip)) {  \
-        status->ipListRemote += line;                                            \
-    }                                                                            \
-    for (const auto &line: SplitLinesSkipSharp(dataStore->routing->direct_ip)) { \
-        status->ipListDirect += line;                                            \
+#define IP_USER_RULE                                                      \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->block_ip)) {  \
+        status->ipListBlock += line;                                      \
+    }                                                                     \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->proxy_ip)) {  \
+        status->ipListRemote += line;                                     \
+    }                                                                     \
+    for (const auto &line: SplitLinesSkipSharp(ds->routing->direct_ip)) { \
+        status->ipListDirect += line;                                     \
     }
 
     QString BuildChainInternal(int chainId, const QList<std::shared_ptr<ProxyEntity>> &ents,
                                const std::shared_ptr<BuildConfigStatus> &status) {
+        auto ds = status->ds;
         QString chainTag = "c-" + Int2String(chainId);
         QString chainTagOut;
         bool muxApplied = false;
@@ -187,6 +319,7 @@ namespace NekoGui {
             // profile1                 tag (chainTag)-(id)
             // profile0 (out)           tag (chainTag)-(id) / single: chainTag=g-(id)
             auto tagOut = chainTag + "-" + Int2String(ent->id);
+            status->result->inputProfiles << ent->id;
 
             // needGlobal: can only contain one?
             bool needGlobal = false;
@@ -209,13 +342,6 @@ namespace NekoGui {
                 status->result->ignoreConnTag << tagOut;
             }
 
-            if (needGlobal) {
-                if (status->globalProfiles.contains(ent->id)) {
-                    continue;
-                }
-                status->globalProfiles += ent->id;
-            }
-
             if (index > 0) {
                 // chain rules: past
                 if (pastExternalStat == 0) {
@@ -235,6 +361,14 @@ namespace NekoGui {
                 status->result->outboundStat = ent->traffic_data;
             }
 
+            // a global profile shared by several chains is only built once, the chain rules above still point to it
+            if (needGlobal) {
+                if (status->globalProfiles.contains(ent->id)) {
+                    continue;
+                }
+                status->globalProfiles += ent->id;
+            }
+
             // chain rules: this
             auto ext_mapping_port = 0;
             auto ext_socks_port = 0;
@@ -245,22 +379,29 @@ namespace NekoGui {
             }
 
             // determine port
+            std::list<std::shared_ptr<NekoGui_sys::PortLease>> portLeases;
+            auto leasePort = [&] {
+                auto lease = NekoGui_sys::portPool->Lease();
+                if (lease == nullptr) return MkPort(); // pool exhausted, ask the kernel
+                portLeases.push_back(lease);
+                return lease->port;
+            };
             if (thisExternalStat > 0) {
                 if (ent->type == "custom") {
                     auto bean = ent->CustomBean();
                     if (IsValidPort(bean->mapping_port)) {
                         ext_mapping_port = bean->mapping_port;
                     } else {
-                        ext_mapping_port = MkPort();
+                        ext_mapping_port = leasePort();
                     }
                     if (IsValidPort(bean->socks_port)) {
                         ext_socks_port = bean->socks_port;
                     } else {
-                        ext_socks_port = MkPort();
+                        ext_socks_port = leasePort();
                     }
                 } else {
-                    ext_mapping_port = MkPort();
-                    ext_socks_port = MkPort();
+                    ext_mapping_port = leasePort();
+                    ext_socks_port = leasePort();
                 }
             }
             if (thisExternalStat == 2) dataStore->need_keep_vpn_off = true;
@@ -286,7 +427,7 @@ namespace NekoGui {
             // Outbound
 
             QJsonObject outbound;
-            auto stream = GetStreamSettings(ent->bean.get());
+            auto stream = GetStreamSettings(ent->bean.Get());
 
             if (thisExternalStat > 0) {
                 auto extR = ent->bean->BuildExternal(ext_mapping_port, ext_socks_port, thisExternalStat);
@@ -299,6 +440,8 @@ namespace NekoGui {
                     return {};
                 }
                 extR.tag = ent->bean->DisplayType();
+                extR.ready_port = ext_socks_port;
+                extR.port_leases = portLeases;
                 status->result->extRs.emplace_back(std::make_shared<NekoGui_fmt::ExternalBuildResult>(extR));
 
                 // SOCKS OUTBOUND
@@ -326,14 +469,14 @@ namespace NekoGui {
 
             // mux common
             auto needMux = ent->type == "vmess" || ent->type == "trojan" || ent->type == "vless";
-            needMux &= dataStore->mux_concurrency > 0;
+            needMux &= ds->mux_concurrency > 0;
 
             if (stream != nullptr) {
                 if (stream->network == "grpc" || stream->network == "quic" || (stream->network == "http" && stream->security == "tls")) {
                     needMux = false;
                 }
                 if (stream->multiplex_status == 0) {
-                    if (!dataStore->mux_default_on) needMux = false;
+                    if (!ds->mux_default_on) needMux = false;
                 } else if (stream->multiplex_status == 1) {
                     needMux = true;
                 } else if (stream->multiplex_status == 2) {
@@ -346,14 +489,14 @@ namespace NekoGui {
 
             // common
             // apply domain_strategy
-            outbound["domain_strategy"] = dataStore->routing->outbound_domain_strategy;
+            outbound["domain_strategy"] = ds->routing->outbound_domain_strategy;
             // apply mux
             if (!muxApplied && needMux) {
                 auto muxObj = QJsonObject{
                     {"enabled", true},
-                    {"protocol", dataStore->mux_protocol},
-                    {"padding", dataStore->mux_padding},
-                    {"max_streams", dataStore->mux_concurrency},
+                    {"protocol", ds->mux_protocol},
+                    {"padding", ds->mux_padding},
+                    {"max_streams", ds->mux_concurrency},
                 };
                 outbound["multiplex"] = muxObj;
                 muxApplied = true;
@@ -365,7 +508,7 @@ namespace NekoGui {
             // Bypass Lookup for the first profile
             auto serverAddress = ent->bean->serverAddress;
 
-            auto customBean = dynamic_cast<NekoGui_fmt::CustomBean *>(ent->bean.get());
+            auto customBean = std::dynamic_pointer_cast<NekoGui_fmt::CustomBean>(ent->bean.Get());
             if (customBean != nullptr && customBean->core == "internal") {
                 auto server = QString2QJsonObject(customBean->config_simple)["server"].toString();
                 if (!server.isEmpty()) serverAddress = server;
@@ -387,52 +530,57 @@ namespace NekoGui {
     // SingBox
 
     void BuildConfigSingBox(const std::shared_ptr<BuildConfigStatus> &status) {
+        auto ds = status->ds;
         // Log
-        status->result->coreConfig["log"] = QJsonObject{{"level", dataStore->log_level}};
+        status->result->coreConfig["log"] = QJsonObject{{"level", ds->log_level}};
 
         // Inbounds
 
-        // mixed-in
-        if (IsValidPort(dataStore->inbound_socks_port) && !status->forTest) {
+        auto makeMixedInbound = [&](const QString &tag, int port) {
             QJsonObject inboundObj;
-            inboundObj["tag"] = "mixed-in";
+            inboundObj["tag"] = tag;
             inboundObj["type"] = "mixed";
-            inboundObj["listen"] = dataStore->inbound_address;
-            inboundObj["listen_port"] = dataStore->inbound_socks_port;
-            if (dataStore->routing->sniffing_mode != SniffingMode::DISABLE) {
+            inboundObj["listen"] = ds->inbound_address;
+            inboundObj["listen_port"] = port;
+            if (ds->routing->sniffing_mode != SniffingMode::DISABLE) {
                 inboundObj["sniff"] = true;
-                inboundObj["sniff_override_destination"] = dataStore->routing->sniffing_mode == SniffingMode::FOR_DESTINATION;
+                inboundObj["sniff_override_destination"] = ds->routing->sniffing_mode == SniffingMode::FOR_DESTINATION;
             }
-            if (dataStore->inbound_auth->NeedAuth()) {
+            if (ds->inbound_auth->NeedAuth()) {
                 inboundObj["users"] = QJsonArray{
                     QJsonObject{
-                        {"username", dataStore->inbound_auth->username},
-                        {"password", dataStore->inbound_auth->password},
+                        {"username", ds->inbound_auth->username},
+                        {"password", ds->inbound_auth->password},
                     },
                 };
             }
-            inboundObj["domain_strategy"] = dataStore->routing->domain_strategy;
-            status->inbounds += inboundObj;
+            inboundObj["domain_strategy"] = ds->routing->domain_strategy;
+            return inboundObj;
+        };
+
+        // mixed-in
+        if (IsValidPort(ds->inbound_socks_port) && !status->forTest && status->servePorts.isEmpty()) {
+            status->inbounds += makeMixedInbound("mixed-in", ds->inbound_socks_port);
         }
 
         // tun-in
-        if (dataStore->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
+        if (ds->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest && status->servePorts.isEmpty()) {
             QJsonObject inboundObj;
             inboundObj["tag"] = "tun-in";
             inboundObj["type"] = "tun";
             inboundObj["interface_name"] = genTunName();
             inboundObj["auto_route"] = true;
             inboundObj["endpoint_independent_nat"] = true;
-            inboundObj["mtu"] = dataStore->vpn_mtu;
-            inboundObj["stack"] = Preset::SingBox::VpnImplementation.value(dataStore->vpn_implementation);
-            inboundObj["strict_route"] = dataStore->vpn_strict_route;
+            inboundObj["mtu"] = ds->vpn_mtu;
+            inboundObj["stack"] = Preset::SingBox::VpnImplementation.value(ds->vpn_implementation);
+            inboundObj["strict_route"] = ds->vpn_strict_route;
             inboundObj["inet4_address"] = "172.19.0.1/28";
-            if (dataStore->vpn_ipv6) inboundObj["inet6_address"] = "fdfe:dcba:9876::1/126";
-            if (dataStore->routing->sniffing_mode != SniffingMode::DISABLE) {
+            if (ds->vpn_ipv6) inboundObj["inet6_address"] = "fdfe:dcba:9876::1/126";
+            if (ds->routing->sniffing_mode != SniffingMode::DISABLE) {
                 inboundObj["sniff"] = true;
-                inboundObj["sniff_override_destination"] = dataStore->routing->sniffing_mode == SniffingMode::FOR_DESTINATION;
+                inboundObj["sniff_override_destination"] = ds->routing->sniffing_mode == SniffingMode::FOR_DESTINATION;
             }
-            inboundObj["domain_strategy"] = dataStore->routing->domain_strategy;
+            inboundObj["domain_strategy"] = ds->routing->domain_strategy;
             status->inbounds += inboundObj;
         }
 
@@ -440,6 +588,23 @@ namespace NekoGui {
         auto tagProxy = BuildChain(0, status);
         if (!status->result->error.isEmpty()) return;
 
+        // serving mode: every port goes straight to its profile, profiles on several ports are built once
+        QJsonArray serveRules;
+        auto mainEnt = status->ent;
+        for (auto it = status->servePorts.cbegin(); it != status->servePorts.cend(); ++it) {
+            status->ent = profileManager->GetProfile(it.value());
+            auto tagServe = BuildChain(status->ent->id + 1, status);
+            if (!status->result->error.isEmpty()) return;
+
+            auto tagInbound = "serve-" + Int2String(it.key());
+            status->inbounds += makeMixedInbound(tagInbound, it.key());
+            serveRules += QJsonObject{
+                {"inbound", QJsonArray{tagInbound}},
+                {"outbound", tagServe},
+            };
+        }
+        status->ent = mainEnt;
+
         // direct & bypass & block
         status->outbounds += QJsonObject{
             {"type", "direct"},
@@ -461,7 +626,7 @@ namespace NekoGui {
         }
 
         // custom inbound
-        if (!status->forTest) QJSONARRAY_ADD(status->inbounds, QString2QJsonObject(dataStore->custom_inbound)["inbounds"].toArray())
+        if (!status->forTest) QJSONARRAY_ADD(status->inbounds, QString2QJsonObject(ds->custom_inbound)["inbounds"].toArray())
 
         status->result->coreConfig.insert("inbounds", status->inbounds);
         status->result->coreConfig.insert("outbounds", status->outbounds);
@@ -470,6 +635,15 @@ namespace NekoGui {
         if (!status->forTest) {
             DOMAIN_USER_RULE
             IP_USER_RULE
+            // in route rule order
+            status->result->ruleConflicts += MinimizeDomainLists({{"block_domain", &status->domainListBlock},
+                                                                  {"proxy_domain", &status->domainListRemote},
+                                                                  {"direct_domain", &status->domainListDirect}});
+            status->result->ruleConflicts += MinimizeIPLists({{"block_ip", &status->ipListBlock},
+                                                              {"proxy_ip", &status->ipListRemote},
+                                                              {"direct_ip", &status->ipListDirect}});
+            MinimizeDomainLists({{"dns remote", &status->domainListDNSRemote},
+                                 {"dns direct", &status->domainListDNSDirect}});
         }
 
         // sing-box common rule object
@@ -525,6 +699,42 @@ namespace NekoGui {
             return rule;
         };
 
+        // big lists go to a cached rule-set, geosite / geoip stay inline
+        auto make_rules = [&](const QStringList &list, bool isIP) {
+            QList<QJsonObject> rules;
+            QStringList inlined;
+            QStringList plain;
+            for (const auto &item: list) {
+                if (item.startsWith(isIP ? "geoip:" : "geosite:")) {
+                    inlined += item;
+                } else {
+                    plain += item;
+                }
+            }
+            if (status->forExport || plain.size() < RuleSetCache::minEntries) {
+                inlined += plain;
+                plain.clear();
+            }
+            if (!plain.isEmpty()) {
+                auto ruleSet = ruleSetCache->Get(plain, isIP, [&] {
+                    auto rule = make_rule(plain, isIP);
+                    // the headless rule has no geo fields
+                    rule.remove("geoip");
+                    rule.remove("geosite");
+                    return rule;
+                });
+                if (ruleSet.tag.isEmpty()) {
+                    inlined += plain;
+                } else {
+                    status->ruleSets[ruleSet.tag] = ruleSet.ToJson();
+                    rules += QJsonObject{{"rule_set", ruleSet.tag}};
+                }
+            }
+            auto rule = make_rule(inlined, isIP);
+            if (!rule.isEmpty()) rules.prepend(rule);
+            return rules;
+        };
+
         // final add DNS
         QJsonObject dns;
         QJsonArray dnsServers;
@@ -535,8 +745,8 @@ namespace NekoGui {
             dnsServers += QJsonObject{
                 {"tag", "dns-remote"},
                 {"address_resolver", "dns-local"},
-                {"strategy", dataStore->routing->remote_dns_strategy},
-                {"address", dataStore->routing->remote_dns},
+                {"strategy", ds->routing->remote_dns_strategy},
+                {"address", ds->routing->remote_dns},
                 {"detour", tagProxy},
             };
 
@@ -544,11 +754,11 @@ namespace NekoGui {
         QJsonObject directObj{
             {"tag", "dns-direct"},
             {"address_resolver", "dns-local"},
-            {"strategy", dataStore->routing->direct_dns_strategy},
-            {"address", dataStore->routing->direct_dns},
+            {"strategy", ds->routing->direct_dns_strategy},
+            {"address", ds->routing->direct_dns},
             {"detour", "direct"},
         };
-        if (dataStore->routing->dns_final_out == "bypass") {
+        if (ds->routing->dns_final_out == "bypass") {
             dnsServers.prepend(directObj);
         } else {
             dnsServers.append(directObj);
@@ -566,7 +776,7 @@ namespace NekoGui {
             };
 
         // Fakedns
-        if (dataStore->fake_dns && dataStore->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
+        if (ds->fake_dns && ds->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
             dnsServers += QJsonObject{
                 {"tag", "dns-fake"},
                 {"address", "fakeip"},
@@ -587,10 +797,10 @@ namespace NekoGui {
 
         // sing-box dns rule object
         auto add_rule_dns = [&](const QStringList &list, const QString &server) {
-            auto rule = make_rule(list, false);
-            if (rule.isEmpty()) return;
-            rule["server"] = server;
-            dnsRules += rule;
+            for (auto rule: make_rules(list, false)) {
+                rule["server"] = server;
+                dnsRules += rule;
+            }
         };
         add_rule_dns(status->domainListDNSRemote, "dns-remote");
         add_rule_dns(status->domainListDNSDirect, "dns-direct");
@@ -608,7 +818,7 @@ namespace NekoGui {
         }
 
         // fakedns rule
-        if (dataStore->fake_dns && dataStore->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
+        if (ds->fake_dns && ds->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
             dnsRules += QJsonObject{
                 {"inbound", "tun-in"},
                 {"server", "dns-fake"},
@@ -619,8 +829,8 @@ namespace NekoGui {
         dns["rules"] = dnsRules;
         dns["independent_cache"] = true;
 
-        if (dataStore->routing->use_dns_object) {
-            dns = QString2QJsonObject(dataStore->routing->dns_object);
+        if (ds->routing->use_dns_object) {
+            dns = QString2QJsonObject(ds->routing->dns_object);
         }
         status->result->coreConfig.insert("dns", dns);
 
@@ -633,13 +843,14 @@ namespace NekoGui {
                 {"outbound", "dns-out"},
             };
         }
+        QJSONARRAY_ADD(status->routingRules, serveRules)
 
         // sing-box routing rule object
         auto add_rule_route = [&](const QStringList &list, bool isIP, const QString &out) {
-            auto rule = make_rule(list, isIP);
-            if (rule.isEmpty()) return;
-            rule["outbound"] = out;
-            status->routingRules += rule;
+            for (auto rule: make_rules(list, isIP)) {
+                rule["outbound"] = out;
+                status->routingRules += rule;
+            }
         };
 
         // final add user rule
@@ -666,10 +877,10 @@ namespace NekoGui {
         };
 
         // tun user rule
-        if (dataStore->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
-            auto match_out = dataStore->vpn_rule_white ? "proxy" : "bypass";
+        if (ds->vpn_internal_tun && dataStore->spmode_vpn && !status->forTest) {
+            auto match_out = ds->vpn_rule_white ? "proxy" : "bypass";
 
-            QString process_name_rule = dataStore->vpn_rule_process.trimmed();
+            QString process_name_rule = ds->vpn_rule_process.trimmed();
             if (!process_name_rule.isEmpty()) {
                 auto arr = SplitLinesSkipSharp(process_name_rule);
                 QJsonObject rule{{"outbound", match_out},
@@ -677,7 +888,7 @@ namespace NekoGui {
                 status->routingRules += rule;
             }
 
-            QString cidr_rule = dataStore->vpn_rule_cidr.trimmed();
+            QString cidr_rule = ds->vpn_rule_cidr.trimmed();
             if (!cidr_rule.isEmpty()) {
                 auto arr = SplitLinesSkipSharp(cidr_rule);
                 QJsonObject rule{{"outbound", match_out},
@@ -700,9 +911,9 @@ namespace NekoGui {
         if (geosite.isEmpty()) status->result->error = +"geosite.db not found";
 
         // final add routing rule
-        auto routingRules = QString2QJsonObject(dataStore->routing->custom)["rules"].toArray();
+        auto routingRules = QString2QJsonObject(ds->routing->custom)["rules"].toArray();
         if (status->forTest) routingRules = {};
-        if (!status->forTest) QJSONARRAY_ADD(routingRules, QString2QJsonObject(dataStore->custom_route_global)["rules"].toArray())
+        if (!status->forTest) QJSONARRAY_ADD(routingRules, QString2QJsonObject(ds->custom_route_global)["rules"].toArray())
         QJSONARRAY_ADD(routingRules, status->routingRules)
         auto routeObj = QJsonObject{
             {"rules", routingRules},
@@ -719,7 +930,12 @@ namespace NekoGui {
                     {"path", geosite},
                 },
             }};
-        if (!status->forTest) routeObj["final"] = dataStore->routing->def_outbound;
+        if (!status->ruleSets.isEmpty()) {
+            QJsonArray ruleSets;
+            for (const auto &ruleSet: status->ruleSets) ruleSets += ruleSet;
+            routeObj["rule_set"] = ruleSets;
+        }
+        if (!status->forTest) routeObj["final"] = ds->routing->def_outbound;
         if (status->forExport) {
             routeObj.remove("geoip");
             routeObj.remove("geosite");
@@ -730,24 +946,28 @@ namespace NekoGui {
         // experimental
         QJsonObject experimentalObj;
 
-        if (!status->forTest && dataStore->core_box_clash_api > 0) {
+        if (!status->forTest && ds->core_box_clash_api > 0) {
             QJsonObject clash_api = {
-                {"external_controller", "127.0.0.1:" + Int2String(dataStore->core_box_clash_api)},
-                {"secret", dataStore->core_box_clash_api_secret},
+                {"external_controller", "127.0.0.1:" + Int2String(ds->core_box_clash_api)},
+                {"secret", ds->core_box_clash_api_secret},
                 {"external_ui", "dashboard"},
             };
             experimentalObj["clash_api"] = clash_api;
+        } else if (!status->forTest && (!status->result->balancerTags.isEmpty() || ds->connection_statistics)) {
+            // urltest history and the connection tracker live in the clash server, no controller is opened
+            experimentalObj["clash_api"] = QJsonObject{};
         }
 
         if (!experimentalObj.isEmpty()) status->result->coreConfig.insert("experimental", experimentalObj);
     }
 
     QString WriteVPNSingBoxConfig() {
+        auto ds = dataStore->Snapshot();
         // tun user rule
-        auto match_out = dataStore->vpn_rule_white ? "neko-socks" : "direct";
-        auto no_match_out = dataStore->vpn_rule_white ? "direct" : "neko-socks";
+        auto match_out = ds->vpn_rule_white ? "neko-socks" : "direct";
+        auto no_match_out = ds->vpn_rule_white ? "direct" : "neko-socks";
 
-        QString process_name_rule = dataStore->vpn_rule_process.trimmed();
+        QString process_name_rule = ds->vpn_rule_process.trimmed();
         if (!process_name_rule.isEmpty()) {
             auto arr = SplitLinesSkipSharp(process_name_rule);
             QJsonObject rule{{"outbound", match_out},
@@ -755,7 +975,7 @@ namespace NekoGui {
             process_name_rule = "," + QJsonObject2QString(rule, false);
         }
 
-        QString cidr_rule = dataStore->vpn_rule_cidr.trimmed();
+        QString cidr_rule = ds->vpn_rule_cidr.trimmed();
         if (!cidr_rule.isEmpty()) {
             auto arr = SplitLinesSkipSharp(cidr_rule);
             QJsonObject rule{{"outbound", match_out},
@@ -767,26 +987,26 @@ namespace NekoGui {
 
         // auth
         QString socks_user_pass;
-        if (dataStore->inbound_auth->NeedAuth()) {
+        if (ds->inbound_auth->NeedAuth()) {
             socks_user_pass = R"( "username": "%1", "password": "%2", )";
-            socks_user_pass = socks_user_pass.arg(dataStore->inbound_auth->username, dataStore->inbound_auth->password);
+            socks_user_pass = socks_user_pass.arg(ds->inbound_auth->username, ds->inbound_auth->password);
         }
         // gen config
         auto configFn = ":/neko/vpn/sing-box-vpn.json";
         if (QFile::exists("vpn/sing-box-vpn.json")) configFn = "vpn/sing-box-vpn.json";
         auto config = ReadFileText(configFn)
-                          .replace("//%IPV6_ADDRESS%", dataStore->vpn_ipv6 ? R"("inet6_address": "fdfe:dcba:9876::1/126",)" : "")
+                          .replace("//%IPV6_ADDRESS%", ds->vpn_ipv6 ? R"("inet6_address": "fdfe:dcba:9876::1/126",)" : "")
                           .replace("//%SOCKS_USER_PASS%", socks_user_pass)
                           .replace("//%PROCESS_NAME_RULE%", process_name_rule)
                           .replace("//%CIDR_RULE%", cidr_rule)
-                          .replace("%MTU%", Int2String(dataStore->vpn_mtu))
-                          .replace("%STACK%", Preset::SingBox::VpnImplementation.value(dataStore->vpn_implementation))
+                          .replace("%MTU%", Int2String(ds->vpn_mtu))
+                          .replace("%STACK%", Preset::SingBox::VpnImplementation.value(ds->vpn_implementation))
                           .replace("%TUN_NAME%", genTunName())
-                          .replace("%STRICT_ROUTE%", dataStore->vpn_strict_route ? "true" : "false")
+                          .replace("%STRICT_ROUTE%", ds->vpn_strict_route ? "true" : "false")
                           .replace("%FINAL_OUT%", no_match_out)
                           .replace("%DNS_ADDRESS%", BOX_UNDERLYING_DNS)
-                          .replace("%FAKE_DNS_INBOUND%", dataStore->fake_dns ? "tun-in" : "empty")
-                          .replace("%PORT%", Int2String(dataStore->inbound_socks_port));
+                          .replace("%FAKE_DNS_INBOUND%", ds->fake_dns ? "tun-in" : "empty")
+                          .replace("%PORT%", Int2String(ds->inbound_socks_port));
         // write config
         QFile file;
         file.setFileName(QFileInfo(configFn).fileName());
@@ -3,6 +3,8 @@
 #include "ProxyEntity.hpp"
 #include "sys/ExternalProcess.hpp"
 
+#include <QSet>
+
 namespace NekoGui {
     class BuildConfigResult {
     public:
@@ -12,6 +14,12 @@ namespace NekoGui {
         QList<std::shared_ptr<NekoGui_traffic::TrafficData>> outboundStats; // all, but not including "bypass" "block"
         std::shared_ptr<NekoGui_traffic::TrafficData> outboundStat;         // main
         QStringList ignoreConnTag;
+        QMap<int, QString> selectorMembers; // profile id -> outbound tag behind the "proxy" selector
+        QStringList balancerTags;           // urltest outbounds
+        QMap<QString, int> balancerMembers; // outbound tag -> profile id, for the latency feedback
+        QStringList ruleConflicts;          // routing entries that can never match
+        QSet<int> inputProfiles;            // every profile and group the build read, for ConfigCache
+        QSet<int> inputGroups;
 
         std::list<std::shared_ptr<NekoGui_fmt::ExternalBuildResult>> extRs;
     };
@@ -22,9 +30,12 @@ namespace NekoGui {
         std::shared_ptr<ProxyEntity> ent;
         bool forTest;
         bool forExport;
+        QMap<int, int> servePorts; // port -> profile id, serving mode
+        std::shared_ptr<const DataStore> ds; // settings for the whole build
 
         // priv
         QList<int> globalProfiles;
+        QMap<int, QString> builtEnts; // profile id -> outbound tag, for profiles used by several groups
 
         // xxList is V2Ray format string list
 
@@ -36,6 +47,7 @@ namespace NekoGui {
         QStringList ipListDirect;
         QStringList domainListBlock;
         QStringList ipListBlock;
+        QMap<QString, QJsonObject> ruleSets; // tag -> route.rule_set entry
 
         // config format
 
@@ -46,6 +58,9 @@ namespace NekoGui {
 
     std::shared_ptr<BuildConfigResult> BuildConfig(const std::shared_ptr<ProxyEntity> &ent, bool forTest, bool forExport);
 
+    // One core serving several profiles at once, each behind its own mixed inbound (port -> profile id)
+    std::shared_ptr<BuildConfigResult> BuildServeConfig(const QMap<int, int> &servePorts);
+
     void BuildConfigSingBox(const std::shared_ptr<BuildConfigStatus> &status);
 
     QString BuildChain(int chainId, const std::shared_ptr<BuildConfigStatus> &status);
@@ -0,0 +1,173 @@
+#include "ConfigCache.hpp"
+#include "db/ConfigBuilder.hpp"
+#include "db/Database.hpp"
+#include "main/NekoGui.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+
+namespace NekoGui {
+
+    ConfigCache *configCache = new ConfigCache;
+
+    namespace {
+        // only what the build reads, not latency or traffic
+        QString profileDigest(int id) {
+            auto ent = profileManager->GetProfile(id);
+            if (ent == nullptr) return {};
+            auto bean = ent->bean.Get();
+            if (bean == nullptr) return {};
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(ent->type.toUtf8() + "\n" + QByteArray::number(ent->gid) + "\n");
+            hash.addData(bean->ToJsonBytes());
+            return hash.result().toHex();
+        }
+
+        // members decide a balancer or selector as much as the group settings
+        QString groupDigest(int id) {
+            auto group = profileManager->GetGroup(id);
+            if (group == nullptr) return {};
+            QCryptographicHash hash(QCryptographicHash::Sha1);
+            hash.addData(group->ToJsonBytes());
+            for (const auto &ent: group->Profiles()) hash.addData(QByteArray::number(ent->id) + ",");
+            return hash.result().toHex();
+        }
+
+        QString basePath(const QByteArray &key) {
+            return QFileInfo("config_cache/" + key).absoluteFilePath();
+        }
+    } // namespace
+
+    QByteArray ConfigCache::Key(int profileId, const QMap<int, int> &servePorts) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        // an upgrade may build another config from the same inputs
+        hash.addData("nekoray " NKR_VERSION " generator " + QByteArray::number(generatorVersion) + "\n");
+        hash.addData("profile " + QByteArray::number(profileId) + "\n");
+        for (auto it = servePorts.cbegin(); it != servePorts.cend(); ++it) {
+            hash.addData("serve " + QByteArray::number(it.key()) + " " + QByteArray::number(it.value()) + "\n");
+        }
+        // remember_id is saved on every start but never read by the build
+        hash.addData(QJsonDocument(dataStore->ToJson({"remember_id"})).toJson(QJsonDocument::Compact));
+        if (dataStore->routing != nullptr) hash.addData(dataStore->routing->ToJsonBytes());
+        hash.addData(dataStore->spmode_vpn ? "vpn\n" : "\n");
+        return hash.result().toHex();
+    }
+
+    bool ConfigCache::Get(int profileId, const QMap<int, int> &servePorts, Entry &entry) {
+        auto base = basePath(Key(profileId, servePorts));
+
+        QMutexLocker locker(&mutex);
+        // a miss leaves nothing behind, Put writes both files
+        if (!QFile::exists(base + ".json")) return false;
+        QFile f(base + ".meta.json");
+        if (!f.open(QIODevice::ReadOnly)) return false;
+        auto meta = QJsonDocument::fromJson(f.readAll()).object();
+        f.close();
+        if (meta.isEmpty()) return false;
+
+        auto profiles = meta["profiles"].toObject();
+        for (auto it = profiles.begin(); it != profiles.end(); ++it) {
+            if (it.value().toString() != profileDigest(it.key().toInt())) return false;
+        }
+        auto groups = meta["groups"].toObject();
+        for (auto it = groups.begin(); it != groups.end(); ++it) {
+            if (it.value().toString() != groupDigest(it.key().toInt())) return false;
+        }
+        // the rule-set cache may have pruned them
+        for (const auto &path: meta["rule_sets"].toArray()) {
+            if (!QFile::exists(path.toString())) return false;
+        }
+
+        // a hit, Prune drops the oldest used
+        if (f.open(QIODevice::ReadWrite)) {
+            f.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+            f.close();
+        }
+
+        entry = {};
+        entry.path = base + ".json";
+        auto selectorMembers = meta["selector_members"].toObject();
+        for (auto it = selectorMembers.begin(); it != selectorMembers.end(); ++it) {
+            entry.selectorMembers[it.key().toInt()] = it.value().toString();
+        }
+        for (const auto &tag: meta["balancer_tags"].toArray()) entry.balancerTags << tag.toString();
+        auto balancerMembers = meta["balancer_members"].toObject();
+        for (auto it = balancerMembers.begin(); it != balancerMembers.end(); ++it) {
+            entry.balancerMembers[it.key()] = it.value().toInt();
+        }
+        for (const auto &conflict: meta["rule_conflicts"].toArray()) entry.ruleConflicts << conflict.toString();
+        return true;
+    }
+
+    QString ConfigCache::Put(int profileId, const QMap<int, int> &servePorts, const BuildConfigResult &result, const QJsonObject &coreConfig) {
+        if (!result.error.isEmpty() || !result.extRs.empty()) return {};
+
+        QJsonObject profiles;
+        for (auto id: result.inputProfiles) {
+            auto digest = profileDigest(id);
+            if (digest.isEmpty()) return {};
+            profiles[Int2String(id)] = digest;
+        }
+        QJsonObject groups;
+        for (auto id: result.inputGroups) {
+            auto digest = groupDigest(id);
+            if (digest.isEmpty()) return {};
+            groups[Int2String(id)] = digest;
+        }
+        QJsonArray ruleSets;
+        for (const auto &ruleSet: coreConfig["route"].toObject()["rule_set"].toArray()) {
+            auto path = ruleSet.toObject()["path"].toString();
+            if (!path.isEmpty()) ruleSets += path;
+        }
+        QJsonObject selectorMembers;
+        for (auto it = result.selectorMembers.cbegin(); it != result.selectorMembers.cend(); ++it) {
+            selectorMembers[Int2String(it.key())] = it.value();
+        }
+        QJsonObject balancerMembers;
+        for (auto it = result.balancerMembers.cbegin(); it != result.balancerMembers.cend(); ++it) {
+            balancerMembers[it.key()] = it.value();
+        }
+        QJsonObject meta{
+            {"profiles", profiles},
+            {"groups", groups},
+            {"rule_sets", ruleSets},
+            {"selector_members", selectorMembers},
+            {"balancer_tags", QJsonArray::fromStringList(result.balancerTags)},
+            {"balancer_members", balancerMembers},
+            {"rule_conflicts", QJsonArray::fromStringList(result.ruleConflicts)},
+        };
+
+        auto base = basePath(Key(profileId, servePorts));
+
+        QMutexLocker locker(&mutex);
+        QDir().mkpath("config_cache");
+        // the config first, a meta file always has its config
+        QFile config(base + ".json");
+        if (!config.open(QIODevice::WriteOnly)) return {};
+        config.write(QJsonObject2QString(coreConfig, false).toUtf8());
+        config.close();
+        QFile f(base + ".meta.json");
+        if (!f.open(QIODevice::WriteOnly)) return {};
+        f.write(QJsonDocument(meta).toJson(QJsonDocument::Compact));
+        f.close();
+
+        Prune();
+        return config.fileName();
+    }
+
+    void ConfigCache::Prune() {
+        QDir dir("config_cache");
+        auto files = dir.entryInfoList({"*.meta.json"}, QDir::Files, QDir::Time);
+        for (int i = maxEntries; i < files.size(); i++) {
+            auto base = files[i].absolutePath() + "/" + files[i].fileName().chopped(10); // ".meta.json"
+            QFile::remove(base + ".meta.json");
+            QFile::remove(base + ".json");
+        }
+    }
+
+} // namespace NekoGui
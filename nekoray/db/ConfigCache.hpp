@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QMap>
+#include <QMutex>
+#include <QStringList>
+
+namespace NekoGui {
+    class BuildConfigResult;
+
+    // Generated core configs are kept under config_cache/, so a restart with
+    // unchanged inputs hands the old file to the core instead of building it.
+    // An entry is found by the profiles it was built for, the settings, the
+    // routing and the program and generator versions; it's only used while
+    // every profile and group the build read and the rule-set files it points
+    // to are unchanged.
+    class ConfigCache {
+    public:
+        static constexpr int maxEntries = 16;
+        // part of every key, bump it when ConfigBuilder makes a different config from the same inputs
+        static constexpr int generatorVersion = 1;
+
+        struct Entry {
+            QString path; // the config, ready for the core
+            QMap<int, QString> selectorMembers;
+            QStringList balancerTags;
+            QMap<QString, int> balancerMembers;
+            QStringList ruleConflicts;
+        };
+
+        // profileId for a single profile, servePorts for serving mode
+        bool Get(int profileId, const QMap<int, int> &servePorts, Entry &entry);
+
+        // Stores coreConfig, the final config made from result. Builds that need
+        // external cores aren't kept, their ports are leased per run.
+        // Returns the path of the stored config, empty when it isn't kept.
+        QString Put(int profileId, const QMap<int, int> &servePorts, const BuildConfigResult &result, const QJsonObject &coreConfig);
+
+    private:
+        QMutex mutex;
+
+        static QByteArray Key(int profileId, const QMap<int, int> &servePorts);
+
+        static void Prune();
+    };
+
+    extern ConfigCache *configCache;
+} // namespace NekoGui
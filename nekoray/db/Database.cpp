@@ -1,17 +1,20 @@
 #include "Database.hpp"
 
 #include "fmt/includes.h"
+#include "db/traffic/TrafficHistory.hpp"
 
 #include <QFile>
 #include <QDir>
+#include <QJsonDocument>
 #include <QColor>
+#include <QSet>
 
 namespace NekoGui {
 
     ProfileManager *profileManager = new ProfileManager();
 
-    ProfileManager::ProfileManager() : JsonStore("groups/pm.json") {
-        _add(new configItem("groups", &groupsTabOrder, itemType::integerList));
+    ProfileManager::ProfileManager() : JsonStore("groups/pm.json"), epoch(GetRandomString(8)) {
+        _add("groups", &groupsTabOrder, itemType::integerList);
     }
 
     QList<int> filterIntJsonFile(const QString &path) {
@@ -33,10 +36,12 @@ namespace NekoGui {
     }
 
     void ProfileManager::LoadManager() {
+        BeginUpdate();
         JsonStore::Load();
         //
-        profiles = {};
+        editProfiles().profiles.clear();
         groups = {};
+        index.Clear();
         profilesIdOrder = filterIntJsonFile("profiles");
         groupsIdOrder = filterIntJsonFile("groups");
         // Load Proxys
@@ -44,16 +49,15 @@ namespace NekoGui {
         for (auto id: profilesIdOrder) {
             auto ent = LoadProxyEntity(QStringLiteral("profiles/%1.json").arg(id));
             // Corrupted profile?
-            if (ent == nullptr || ent->bean == nullptr || ent->bean->version == -114514) {
+            if (ent == nullptr) {
                 delProfile << id;
                 continue;
             }
-            profiles[id] = ent;
+            editProfiles().profiles.insert_or_assign(id, ent);
+            index.Update(ent.get());
         }
         // Clear Corrupted profile
-        for (auto id: delProfile) {
-            DeleteProfile(id);
-        }
+        DeleteProfiles(delProfile);
         // Load Groups
         auto loadedOrder = groupsTabOrder;
         groupsTabOrder = {};
@@ -85,7 +89,7 @@ namespace NekoGui {
         if (dataStore->flag_reorder) {
             {
                 // remove all (contains orphan)
-                for (const auto &profile: profiles) {
+                for (const auto &profile: editProfiles().profiles) {
                     QFile::remove(profile.second->fn);
                 }
             }
@@ -94,7 +98,7 @@ namespace NekoGui {
                 int i = 0;
                 int ii = 0;
                 QList<int> newProfilesIdOrder;
-                std::map<int, std::shared_ptr<ProxyEntity>> newProfiles;
+                ProfileMap newProfiles;
                 for (auto gid: groupsTabOrder) {
                     auto group = GetGroup(gid);
                     gidOld2New[gid] = ii++;
@@ -105,13 +109,13 @@ namespace NekoGui {
                         profile->gid = gidOld2New[gid];
                         profile->fn = QStringLiteral("profiles/%1.json").arg(newId);
                         profile->Save();
-                        newProfiles[newId] = profile;
+                        newProfiles.insert_or_assign(newId, profile);
                         newProfilesIdOrder << newId;
                     }
                     group->order = {};
                     group->Save();
                 }
-                profiles = newProfiles;
+                editProfiles().profiles = newProfiles;
                 profilesIdOrder = newProfilesIdOrder;
             }
             {
@@ -133,6 +137,8 @@ namespace NekoGui {
             }
             MessageBoxInfo(software_name, "Profiles and groups reorder complete.");
         }
+        pendingReset = true;
+        EndUpdate();
     }
 
     void ProfileManager::SaveManager() {
@@ -140,25 +146,32 @@ namespace NekoGui {
     }
 
     std::shared_ptr<ProxyEntity> ProfileManager::LoadProxyEntity(const QString &jsonPath) {
-        // Load type
-        ProxyEntity ent0(nullptr, nullptr);
-        ent0.fn = jsonPath;
-        auto validJson = ent0.Load();
-        auto type = ent0.type;
-
-        // Load content
-        std::shared_ptr<ProxyEntity> ent;
-        bool validType = validJson;
+        QFile file(jsonPath);
+        if (!file.exists()) return nullptr;
+        if (!file.open(QIODevice::ReadOnly)) {
+            MessageBoxWarning("error", "can not open config " + jsonPath + "\n" + file.errorString());
+            return nullptr;
+        }
+        auto object = QJsonDocument::fromJson(file.readAll()).object();
+        auto type = object["type"].toString();
 
-        if (validType) {
-            ent = NewProxyEntity(type);
-            validType = ent->bean->version != -114514;
+        // only called under the write lock
+        static QHash<QString, bool> knownTypes;
+        if (!knownTypes.contains(type)) {
+            knownTypes[type] = std::unique_ptr<NekoGui_fmt::AbstractBean>(NewBean(type))->version != -114514;
         }
+        if (!knownTypes[type]) return nullptr;
 
-        if (validType) {
-            ent->load_control_must = true;
-            ent->fn = jsonPath;
-            ent->Load();
+        // the bean is parsed on first use
+        auto ent = std::make_shared<ProxyEntity>(nullptr, type, true);
+        ent->fn = jsonPath;
+        auto beanObject = object.take("bean").toObject(); // reading the field would parse it now
+        ent->FromJson(object);
+        if (ent->meta.type.isEmpty()) {
+            // saved before profiles had meta
+            std::unique_ptr<NekoGui_fmt::AbstractBean> bean(NewBean(type));
+            bean->FromJson(beanObject);
+            ent->meta.Update(bean.get());
         }
         return ent;
     }
@@ -166,6 +179,10 @@ namespace NekoGui {
     //  新建的不给 fn 和 id
 
     std::shared_ptr<ProxyEntity> ProfileManager::NewProxyEntity(const QString &type) {
+        return std::make_shared<ProxyEntity>(NewBean(type), type);
+    }
+
+    NekoGui_fmt::AbstractBean *ProfileManager::NewBean(const QString &type) {
         NekoGui_fmt::AbstractBean *bean;
 
         if (type == "socks") {
@@ -176,6 +193,8 @@ namespace NekoGui {
             bean = new NekoGui_fmt::ShadowSocksBean();
         } else if (type == "chain") {
             bean = new NekoGui_fmt::ChainBean();
+        } else if (type == "balancer") {
+            bean = new NekoGui_fmt::BalancerBean();
         } else if (type == "vmess") {
             bean = new NekoGui_fmt::VMessBean();
         } else if (type == "trojan") {
@@ -193,9 +212,7 @@ namespace NekoGui {
         } else {
             bean = new NekoGui_fmt::AbstractBean(-114514);
         }
-
-        auto ent = std::make_shared<ProxyEntity>(bean, type);
-        return ent;
+        return bean;
     }
 
     std::shared_ptr<Group> ProfileManager::NewGroup() {
@@ -205,24 +222,65 @@ namespace NekoGui {
 
     // ProxyEntity
 
-    ProxyEntity::ProxyEntity(NekoGui_fmt::AbstractBean *bean, const QString &type_) {
+    ProxyEntity::ProxyEntity(NekoGui_fmt::AbstractBean *bean, const QString &type_, bool lazy) {
         if (type_ != nullptr) this->type = type_;
 
-        _add(new configItem("type", &type, itemType::string));
-        _add(new configItem("id", &id, itemType::integer));
-        _add(new configItem("gid", &gid, itemType::integer));
-        _add(new configItem("yc", &latency, itemType::integer));
-        _add(new configItem("report", &full_test_report, itemType::string));
+        _add("type", &type, itemType::string);
+        _add("id", &id, itemType::integer);
+        _add("gid", &gid, itemType::integer);
+        _add("yc", &latency, itemType::integer);
+        _add("report", &full_test_report, itemType::string);
 
         // 可以不关联 bean，只加载 ProxyEntity 的信息
-        if (bean != nullptr) {
-            this->bean = std::shared_ptr<NekoGui_fmt::AbstractBean>(bean);
-            // 有虚函数就要在这里 dynamic_cast
-            _add(new configItem("bean", dynamic_cast<JsonStore *>(bean), itemType::jsonStore));
-            _add(new configItem("traffic", dynamic_cast<JsonStore *>(traffic_data.get()), itemType::jsonStore));
+        if (bean != nullptr || lazy) {
+            if (bean != nullptr) this->bean.bean = std::shared_ptr<NekoGui_fmt::AbstractBean>(bean);
+            // lazy 时由 BeanCache 读取, held while the field is read or written
+            _addStore("bean", [this] { return std::shared_ptr<JsonStore>(this->bean.Get()); });
+            _add("traffic", dynamic_cast<JsonStore *>(traffic_data.get()), itemType::jsonStore);
+            _add("meta", dynamic_cast<JsonStore *>(&meta), itemType::jsonStore);
+            callback_before_save = [this] {
+                PrepareSave();
+                if (profileManager != nullptr) {
+                    profileManager->index.Update(this);
+                    profileManager->Touch(this);
+                }
+            };
         }
     };
 
+    ProxyEntity::~ProxyEntity() {
+        beanCache->Forget(this);
+    }
+
+    void ProxyEntity::PrepareSave() {
+        auto b = bean.Get();
+        if (b == nullptr) return;
+        meta.Update(b.get());
+        beanCache->Saved(this, b->ToJsonBytes());
+    }
+
+    std::shared_ptr<NekoGui_fmt::AbstractBean> BeanRef::Get() const {
+        // loaded: no lock and no clock, only the reference bit for BeanCache::trim
+        auto b = std::atomic_load(&bean);
+        if (b != nullptr) {
+            referenced.store(true, std::memory_order_relaxed);
+            return b;
+        }
+        return beanCache->Get(owner);
+    }
+
+    ProfileMeta::ProfileMeta() {
+        _add("name", &name, itemType::string);
+        _add("address", &address, itemType::string);
+        _add("type", &type, itemType::string);
+    }
+
+    void ProfileMeta::Update(NekoGui_fmt::AbstractBean *bean) {
+        name = bean->name;
+        address = bean->DisplayAddress();
+        type = bean->DisplayType();
+    }
+
     QString ProxyEntity::DisplayLatency() const {
         if (latency < 0) {
             return QObject::tr("Unavailable");
@@ -251,7 +309,7 @@ namespace NekoGui {
     // Profile
 
     int ProfileManager::NewProfileID() const {
-        if (profiles.empty()) {
+        if (profilesIdOrder.isEmpty()) {
             return 0;
         } else {
             return profilesIdOrder.last() + 1;
@@ -263,22 +321,96 @@ namespace NekoGui {
             return false;
         }
 
+        BeginUpdate();
         ent->gid = gid < 0 ? dataStore->current_group : gid;
         ent->id = NewProfileID();
-        profiles[ent->id] = ent;
+        editProfiles().profiles.insert_or_assign(ent->id, ent);
         profilesIdOrder.push_back(ent->id);
+        pendingAdded << ent;
 
         ent->fn = QStringLiteral("profiles/%1.json").arg(ent->id);
         ent->Save();
+        EndUpdate();
+        return true;
+    }
+
+    bool ProfileManager::AddProfiles(const QList<std::shared_ptr<ProxyEntity>> &ents, int gid) {
+        for (const auto &ent: ents) {
+            if (ent->id >= 0) return false;
+        }
+        if (ents.isEmpty()) return true;
+
+        BeginUpdate();
+        // write all files first, in id order, the table is only touched once they all are
+        auto firstId = NewProfileID();
+        QStringList written;
+        bool ok = true;
+        for (int i = 0; ok && i < ents.size(); i++) {
+            const auto &ent = ents[i];
+            ent->gid = gid < 0 ? dataStore->current_group : gid;
+            ent->id = firstId + i;
+            ent->fn = QStringLiteral("profiles/%1.json").arg(ent->id);
+            ent->PrepareSave();
+            ent->last_save_content = ent->ToJsonBytes();
+
+            QFile file(ent->fn);
+            ok = file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            if (ok) {
+                written << ent->fn;
+                ok = file.write(ent->last_save_content) == ent->last_save_content.size();
+                file.close();
+            }
+        }
+
+        if (!ok) {
+            for (const auto &fn: written) QFile::remove(fn);
+            for (const auto &ent: ents) {
+                ent->id = -1;
+                ent->fn = "";
+                ent->last_save_content.clear();
+            }
+            EndUpdate();
+            return false;
+        }
+
+        auto &table = editProfiles();
+        for (const auto &ent: ents) {
+            table.profiles.insert_or_assign(ent->id, ent);
+            profilesIdOrder.push_back(ent->id);
+        }
+        pendingAdded << ents;
+        index.Update(ents);
+        EndUpdate();
         return true;
     }
 
     void ProfileManager::DeleteProfile(int id) {
-        if (id < 0) return;
-        if (dataStore->started_id == id) return;
-        profiles.erase(id);
-        profilesIdOrder.removeAll(id);
-        QFile(QStringLiteral("profiles/%1.json").arg(id)).remove();
+        DeleteProfiles({id});
+    }
+
+    void ProfileManager::DeleteProfiles(const QList<int> &ids) {
+        QSet<int> deleted;
+        BeginUpdate();
+        for (auto id: ids) {
+            if (id < 0 || dataStore->started_id == id) continue;
+            editProfiles().profiles.erase(id);
+            deleted << id;
+        }
+        if (!deleted.isEmpty()) {
+            QList<int> order;
+            for (auto id: profilesIdOrder) {
+                if (!deleted.contains(id)) order << id;
+            }
+            profilesIdOrder = order;
+            pendingDeleted << deleted.values();
+        }
+        EndUpdate();
+
+        index.Remove(deleted.values());
+        for (auto id: deleted) {
+            QFile(QStringLiteral("profiles/%1.json").arg(id)).remove();
+            NekoGui_traffic::trafficHistory->Remove(id);
+        }
     }
 
     void ProfileManager::MoveProfile(const std::shared_ptr<ProxyEntity> &ent, int gid) {
@@ -298,23 +430,156 @@ namespace NekoGui {
     }
 
     std::shared_ptr<ProxyEntity> ProfileManager::GetProfile(int id) {
-        return profiles.count(id) ? profiles[id] : nullptr;
+        auto table = Profiles();
+        auto it = table->profiles.find(id);
+        return it != table->profiles.end() ? it->second : nullptr;
+    }
+
+    std::shared_ptr<const ProfileTable> ProfileManager::Profiles() const {
+        // pending is only touched by the updating thread
+        if (updatingThread == QThread::currentThread() && pending != nullptr) return pending;
+        return std::atomic_load(&published);
+    }
+
+    void ProfileManager::BeginUpdate() {
+        writeMutex.lock();
+        if (updateDepth++ == 0) updatingThread = QThread::currentThread();
+    }
+
+    void ProfileManager::EndUpdate() {
+        if (--updateDepth == 0) {
+            if (pending != nullptr) {
+                std::atomic_store(&published, std::shared_ptr<const ProfileTable>(std::move(pending)));
+            }
+            stampPublished();
+            updatingThread = nullptr;
+        }
+        writeMutex.unlock();
+    }
+
+    // after the publish, so a reader that sees the revision also sees the change
+    void ProfileManager::stampPublished() {
+        std::lock_guard<std::mutex> lock(deletedMutex);
+        if (pendingReset) {
+            // reloaded, nothing older can be synced from
+            deletedLog.clear();
+            deletedFloor = ++revision;
+            for (const auto &[_, ent]: std::atomic_load(&published)->profiles) ent->revision = ++revision;
+            pendingReset = false;
+        }
+        for (const auto &ent: pendingAdded) ent->revision = ++revision;
+        for (auto id: pendingDeleted) deletedLog[++revision] = id;
+        pendingAdded.clear();
+        pendingDeleted.clear();
+        while (deletedLog.size() > maxDeleted) {
+            deletedFloor = deletedLog.begin()->first;
+            deletedLog.erase(deletedLog.begin());
+        }
+    }
+
+    bool ProfileManager::DeletedSince(const QString &sinceEpoch, quint64 since, QList<int> &ids) {
+        std::lock_guard<std::mutex> lock(deletedMutex);
+        if (sinceEpoch != epoch || since < deletedFloor || since > revision) return false;
+        for (auto it = deletedLog.upper_bound(since); it != deletedLog.end(); ++it) ids << it->second;
+        return true;
+    }
+
+    ProfileMap::const_iterator ProfileMap::begin() const {
+        if (shards.empty()) return end();
+        return {shards.begin(), shards.end(), shards.begin()->second->begin()};
+    }
+
+    ProfileMap::const_iterator ProfileMap::find(int id) const {
+        auto outer = shards.find(shardOf(id));
+        if (outer == shards.end()) return end();
+        auto inner = outer->second->find(id);
+        if (inner == outer->second->end()) return end();
+        return {outer, shards.end(), inner};
+    }
+
+    ProfileMap::const_iterator ProfileMap::upper_bound(int id) const {
+        for (auto outer = shards.lower_bound(shardOf(id)); outer != shards.end(); ++outer) {
+            auto inner = outer->second->upper_bound(id);
+            if (inner != outer->second->end()) return {outer, shards.end(), inner};
+        }
+        return end();
+    }
+
+    void ProfileMap::insert_or_assign(int id, const std::shared_ptr<ProxyEntity> &ent) {
+        auto &shard = editShard(shardOf(id));
+        if (shard.insert_or_assign(id, ent).second) total++;
+    }
+
+    void ProfileMap::erase(int id) {
+        auto key = shardOf(id);
+        auto it = shards.find(key);
+        if (it == shards.end() || it->second->count(id) == 0) return;
+        auto &shard = editShard(key);
+        shard.erase(id);
+        total--;
+        if (shard.empty()) shards.erase(key);
+    }
+
+    void ProfileMap::clear() {
+        shards.clear();
+        total = 0;
+    }
+
+    ProfileMap::Shard &ProfileMap::editShard(int key) {
+        // only the writer copies maps and their shard pointers, so the count can't race up
+        auto &shard = shards[key];
+        if (shard == nullptr) {
+            shard = std::make_shared<Shard>();
+        } else if (shard.use_count() > 1) {
+            shard = std::make_shared<Shard>(*shard);
+        }
+        return *shard;
+    }
+
+    ProfileTable &ProfileManager::editProfiles() {
+        // also copied when the updating thread still holds the one Profiles() gave it
+        if (pending == nullptr || pending.use_count() > 1) {
+            auto base = pending != nullptr ? std::shared_ptr<const ProfileTable>(pending) : std::atomic_load(&published);
+            auto version = pending != nullptr ? pending->version : base->version + 1;
+            pending = std::make_shared<ProfileTable>(*base); // shares every shard
+            pending->version = version;
+        }
+        return *pending;
+    }
+
+    QList<int> ProfileManager::SearchProfiles(const QString &query, bool fuzzy) {
+        auto ret = fuzzy ? index.Fuzzy(query) : index.Search(query);
+        if (query.isEmpty()) return ret;
+
+        QList<int> gids;
+        for (const auto &[gid, group]: groups) {
+            if (group->name.contains(query, Qt::CaseInsensitive)) gids << gid;
+        }
+        if (gids.isEmpty()) return ret;
+
+        QSet<int> found;
+        for (auto id: ret) found << id;
+        auto table = Profiles();
+        for (const auto &[id, profile]: table->profiles) {
+            if (gids.contains(profile->gid) && !found.contains(id)) ret << id;
+        }
+        return ret;
     }
 
     // Group
 
     Group::Group() {
-        _add(new configItem("id", &id, itemType::integer));
-        _add(new configItem("front_proxy_id", &front_proxy_id, itemType::integer));
-        _add(new configItem("archive", &archive, itemType::boolean));
-        _add(new configItem("skip_auto_update", &skip_auto_update, itemType::boolean));
-        _add(new configItem("name", &name, itemType::string));
-        _add(new configItem("order", &order, itemType::integerList));
-        _add(new configItem("url", &url, itemType::string));
-        _add(new configItem("info", &info, itemType::string));
-        _add(new configItem("lastup", &sub_last_update, itemType::integer64));
-        _add(new configItem("manually_column_width", &manually_column_width, itemType::boolean));
-        _add(new configItem("column_width", &column_width, itemType::integerList));
+        _add("id", &id, itemType::integer);
+        _add("front_proxy_id", &front_proxy_id, itemType::integer);
+        _add("archive", &archive, itemType::boolean);
+        _add("skip_auto_update", &skip_auto_update, itemType::boolean);
+        _add("name", &name, itemType::string);
+        _add("order", &order, itemType::integerList);
+        _add("url", &url, itemType::string);
+        _add("info", &info, itemType::string);
+        _add("lastup", &sub_last_update, itemType::integer64);
+        _add("manually_column_width", &manually_column_width, itemType::boolean);
+        _add("column_width", &column_width, itemType::integerList);
     }
 
     std::shared_ptr<Group> ProfileManager::LoadGroup(const QString &jsonPath) {
@@ -350,12 +615,11 @@ namespace NekoGui {
     void ProfileManager::DeleteGroup(int gid) {
         if (groups.size() <= 1) return;
         QList<int> toDelete;
-        for (const auto &[id, profile]: profiles) {
-            if (profile->gid == gid) toDelete += id; // map访问中，不能操作
-        }
-        for (const auto &id: toDelete) {
-            DeleteProfile(id);
+        auto table = Profiles();
+        for (const auto &[id, profile]: table->profiles) {
+            if (profile->gid == gid) toDelete += id;
         }
+        DeleteProfiles(toDelete);
         groups.erase(gid);
         groupsIdOrder.removeAll(gid);
         groupsTabOrder.removeAll(gid);
@@ -372,7 +636,8 @@ namespace NekoGui {
 
     QList<std::shared_ptr<ProxyEntity>> Group::Profiles() const {
         QList<std::shared_ptr<ProxyEntity>> ret;
-        for (const auto &[_, profile]: profileManager->profiles) {
+        auto table = profileManager->Profiles();
+        for (const auto &[_, profile]: table->profiles) {
             if (id == profile->gid) ret += profile;
         }
         return ret;
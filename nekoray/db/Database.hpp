@@ -3,8 +3,109 @@
 #include "main/NekoGui.hpp"
 #include "ProxyEntity.hpp"
 #include "Group.hpp"
+#include "ProfileIndex.hpp"
+#include "BeanCache.hpp"
+
+#include <QThread>
+#include <atomic>
+#include <iterator>
+#include <map>
+#include <mutex>
 
 namespace NekoGui {
+    // id -> profile, ordered like the std::map it replaces. Ids are split into shards of
+    // shardSize consecutive ids that copies of the map share, a write copies only the shard
+    // it touches when another copy still holds it. New ids are the highest, so adding one
+    // profile to a published table copies one shard, not every profile.
+    class ProfileMap {
+    public:
+        using Shard = std::map<int, std::shared_ptr<ProxyEntity>>;
+        using value_type = Shard::value_type;
+
+        static constexpr int shardSize = 1024;
+
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = ProfileMap::value_type;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const value_type *;
+            using reference = const value_type &;
+
+            const_iterator() = default;
+
+            reference operator*() const { return *inner; }
+
+            pointer operator->() const { return &*inner; }
+
+            const_iterator &operator++() {
+                if (++inner == outer->second->end()) {
+                    ++outer;
+                    if (outer != outerEnd) inner = outer->second->begin();
+                }
+                return *this;
+            }
+
+            const_iterator operator++(int) {
+                auto it = *this;
+                ++*this;
+                return it;
+            }
+
+            bool operator==(const const_iterator &o) const {
+                return outer == o.outer && (outer == outerEnd || inner == o.inner);
+            }
+
+            bool operator!=(const const_iterator &o) const { return !(*this == o); }
+
+        private:
+            friend class ProfileMap;
+            using Outer = std::map<int, std::shared_ptr<Shard>>::const_iterator;
+
+            Outer outer;
+            Outer outerEnd;
+            Shard::const_iterator inner;
+
+            const_iterator(Outer outer, Outer outerEnd, Shard::const_iterator inner) : outer(outer), outerEnd(outerEnd), inner(inner) {}
+        };
+
+        [[nodiscard]] const_iterator begin() const;
+
+        [[nodiscard]] const_iterator end() const { return {shards.end(), shards.end(), {}}; }
+
+        [[nodiscard]] const_iterator find(int id) const;
+
+        // the first profile with an id above id
+        [[nodiscard]] const_iterator upper_bound(int id) const;
+
+        [[nodiscard]] size_t count(int id) const { return find(id) != end(); }
+
+        [[nodiscard]] bool empty() const { return shards.empty(); }
+
+        [[nodiscard]] size_t size() const { return total; }
+
+        void insert_or_assign(int id, const std::shared_ptr<ProxyEntity> &ent);
+
+        void erase(int id);
+
+        void clear();
+
+    private:
+        std::map<int, std::shared_ptr<Shard>> shards; // id / shardSize -> shard, none empty
+        size_t total = 0;
+
+        static int shardOf(int id) { return id / shardSize; }
+
+        // copy on write, when another ProfileMap shares it
+        Shard &editShard(int key);
+    };
+
+    // Published profiles, never changed after publishing. Each publish bumps the version.
+    struct ProfileTable {
+        quint64 version = 0;
+        ProfileMap profiles;
+    };
+
     class ProfileManager : private JsonStore {
     public:
         // JsonStore
@@ -14,9 +115,11 @@ namespace NekoGui {
 
         // Manager
 
-        std::map<int, std::shared_ptr<ProxyEntity>> profiles;
         std::map<int, std::shared_ptr<Group>> groups;
 
+        // updated on add, delete and save of a profile
+        ProfileIndex index;
+
         ProfileManager();
 
         // LoadManager Reset and loads profiles & groups
@@ -28,14 +131,47 @@ namespace NekoGui {
 
         [[nodiscard]] static std::shared_ptr<Group> NewGroup();
 
+        // -114514 version for an unknown type
+        [[nodiscard]] static NekoGui_fmt::AbstractBean *NewBean(const QString &type);
+
         bool AddProfile(const std::shared_ptr<ProxyEntity> &ent, int gid = -1);
 
+        // All or nothing: ids are allocated together, the files written in one pass and
+        // the profiles published at once. On a failed write nothing is kept.
+        bool AddProfiles(const QList<std::shared_ptr<ProxyEntity>> &ents, int gid = -1);
+
         void DeleteProfile(int id);
 
+        void DeleteProfiles(const QList<int> &ids);
+
         void MoveProfile(const std::shared_ptr<ProxyEntity> &ent, int gid);
 
         std::shared_ptr<ProxyEntity> GetProfile(int id);
 
+        // A consistent view to iterate, readers never wait for writers.
+        // Inside an update, the updating thread sees its own unpublished changes.
+        [[nodiscard]] std::shared_ptr<const ProfileTable> Profiles() const;
+
+        // Adds and deletes between these are published together at the outermost EndUpdate.
+        // Writers are serialized, other writing threads wait until then.
+        void BeginUpdate();
+
+        void EndUpdate();
+
+        // Every publish of an added profile, save and delete takes the next revision,
+        // clients sync by asking for what changed after one they have seen.
+        // Revisions count from 0 in every run, the random epoch tells runs apart.
+        [[nodiscard]] quint64 Revision() const { return revision; }
+
+        [[nodiscard]] const QString &Epoch() const { return epoch; }
+
+        // Profiles deleted after since. False when since is older than the log or
+        // from another epoch, the client has to start over.
+        bool DeletedSince(const QString &sinceEpoch, quint64 since, QList<int> &ids);
+
+        // Profiles whose name, address or type contains query, or in a group whose name does
+        QList<int> SearchProfiles(const QString &query, bool fuzzy = false);
+
         bool AddGroup(const std::shared_ptr<Group> &ent);
 
         void DeleteGroup(int gid);
@@ -44,13 +180,40 @@ namespace NekoGui {
 
         std::shared_ptr<Group> CurrentGroup();
 
+        // called on save, the new content is the change
+        void Touch(ProxyEntity *ent) { ent->revision = ++revision; }
+
     private:
+        // writers
+        std::recursive_mutex writeMutex;
+        int updateDepth = 0;
+        std::atomic<QThread *> updatingThread{nullptr};
+        std::shared_ptr<ProfileTable> pending; // unpublished changes
+
+        std::shared_ptr<const ProfileTable> published = std::make_shared<const ProfileTable>();
+
+        // revisions, stamped once the change is published
+        static constexpr int maxDeleted = 10000;
+        const QString epoch;
+        std::atomic<quint64> revision = 0;
+        QList<std::shared_ptr<ProxyEntity>> pendingAdded;
+        QList<int> pendingDeleted;
+        bool pendingReset = false;
+        std::mutex deletedMutex;
+        std::map<quint64, int> deletedLog; // revision -> id
+        quint64 deletedFloor = 0;         // changes before it are forgotten
+
+        void stampPublished();
+
         // sort by id
         QList<int> profilesIdOrder;
         QList<int> groupsIdOrder;
 
         [[nodiscard]] int NewProfileID() const;
 
+        // copy on write, inside an update
+        ProfileTable &editProfiles();
+
         [[nodiscard]] int NewGroupID() const;
 
         static std::shared_ptr<ProxyEntity> LoadProxyEntity(const QString &jsonPath);
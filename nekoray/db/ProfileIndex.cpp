@@ -0,0 +1,145 @@
+#include "ProfileIndex.hpp"
+#include "ProxyEntity.hpp"
+
+#include <algorithm>
+
+namespace NekoGui {
+
+    QVector<quint64> ProfileIndex::trigrams(const QString &text) {
+        QVector<quint64> ret;
+        for (int i = 0; i + 3 <= text.size(); i++) {
+            ret << (quint64(text[i].unicode()) << 32 | quint64(text[i + 1].unicode()) << 16 | text[i + 2].unicode());
+        }
+        std::sort(ret.begin(), ret.end());
+        ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+        return ret;
+    }
+
+    void ProfileIndex::remove(int id) {
+        auto it = texts.find(id);
+        if (it == texts.end()) return;
+        for (auto t: trigrams(*it)) {
+            auto &ids = postings[t];
+            auto pos = std::lower_bound(ids.begin(), ids.end(), id);
+            if (pos != ids.end() && *pos == id) ids.erase(pos);
+            if (ids.isEmpty()) postings.remove(t);
+        }
+        texts.erase(it);
+    }
+
+    QString ProfileIndex::textOf(const ProxyEntity *ent) {
+        // \n keeps trigrams from spanning two fields
+        return QStringList{ent->meta.name, ent->meta.address, ent->meta.type}.join('\n').toLower();
+    }
+
+    void ProfileIndex::update(int id, const QString &text) {
+        auto it = texts.constFind(id);
+        if (it != texts.constEnd() && *it == text) return; // saved for latency or traffic only
+        remove(id);
+        texts[id] = text;
+        for (auto t: trigrams(text)) {
+            auto &ids = postings[t];
+            ids.insert(std::lower_bound(ids.begin(), ids.end(), id), id);
+        }
+    }
+
+    void ProfileIndex::Update(const ProxyEntity *ent) {
+        if (ent == nullptr || ent->id < 0) return;
+        auto text = textOf(ent);
+        QWriteLocker locker(&lock);
+        update(ent->id, text);
+    }
+
+    void ProfileIndex::Update(const QList<std::shared_ptr<ProxyEntity>> &ents) {
+        QList<QPair<int, QString>> entries;
+        for (const auto &ent: ents) {
+            if (ent == nullptr || ent->id < 0) continue;
+            entries << qMakePair(ent->id, textOf(ent.get()));
+        }
+        QWriteLocker locker(&lock);
+        for (const auto &[id, text]: entries) update(id, text);
+    }
+
+    void ProfileIndex::Remove(int id) {
+        QWriteLocker locker(&lock);
+        remove(id);
+    }
+
+    void ProfileIndex::Remove(const QList<int> &ids) {
+        QWriteLocker locker(&lock);
+        for (auto id: ids) remove(id);
+    }
+
+    void ProfileIndex::Clear() {
+        QWriteLocker locker(&lock);
+        texts.clear();
+        postings.clear();
+    }
+
+    QList<int> ProfileIndex::Search(const QString &query) const {
+        auto q = query.toLower();
+        QList<int> ret;
+        QReadLocker locker(&lock);
+
+        // too short for a trigram
+        if (q.size() < 3) {
+            for (auto it = texts.begin(); it != texts.end(); ++it) {
+                if (it->contains(q)) ret << it.key();
+            }
+            std::sort(ret.begin(), ret.end());
+            return ret;
+        }
+
+        // intersect from the rarest trigram
+        QList<const QVector<int> *> lists;
+        for (auto t: trigrams(q)) {
+            auto it = postings.find(t);
+            if (it == postings.end()) return {};
+            lists << &*it;
+        }
+        std::sort(lists.begin(), lists.end(), [](auto a, auto b) { return a->size() < b->size(); });
+
+        QVector<int> candidates = *lists[0];
+        for (int i = 1; i < lists.size() && !candidates.isEmpty(); i++) {
+            QVector<int> next;
+            std::set_intersection(candidates.begin(), candidates.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(next));
+            candidates = next;
+        }
+
+        // trigrams in any order, verify the substring
+        for (auto id: candidates) {
+            if (texts.value(id).contains(q)) ret << id;
+        }
+        return ret;
+    }
+
+    QList<int> ProfileIndex::Fuzzy(const QString &query, int limit) const {
+        auto grams = trigrams(query.toLower());
+        if (grams.isEmpty()) return Search(query);
+
+        QHash<int, int> scores;
+        {
+            QReadLocker locker(&lock);
+            for (auto t: grams) {
+                auto it = postings.find(t);
+                if (it == postings.end()) continue;
+                for (auto id: *it) scores[id]++;
+            }
+        }
+
+        auto min = (grams.size() + 1) / 2;
+        QList<QPair<int, int>> ranked;
+        for (auto it = scores.begin(); it != scores.end(); ++it) {
+            if (it.value() >= min) ranked << qMakePair(-it.value(), it.key());
+        }
+        std::sort(ranked.begin(), ranked.end());
+
+        QList<int> ret;
+        for (const auto &[_, id]: ranked) {
+            if (ret.size() >= limit) break;
+            ret << id;
+        }
+        return ret;
+    }
+
+} // namespace NekoGui
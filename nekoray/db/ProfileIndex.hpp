@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QHash>
+#include <QList>
+#include <QReadWriteLock>
+#include <QString>
+#include <QVector>
+#include <memory>
+
+namespace NekoGui {
+    class ProxyEntity;
+
+    // Trigram index over profile name, address and type, kept by ProfileManager.
+    // Case-insensitive. Thread-safe: profiles are saved from speed test threads.
+    class ProfileIndex {
+    public:
+        void Update(const ProxyEntity *ent);
+
+        // Same, under one lock
+        void Update(const QList<std::shared_ptr<ProxyEntity>> &ents);
+
+        void Remove(int id);
+
+        void Remove(const QList<int> &ids);
+
+        void Clear();
+
+        // Profiles containing query, by id
+        [[nodiscard]] QList<int> Search(const QString &query) const;
+
+        // Profiles sharing at least half of the query trigrams, best first
+        [[nodiscard]] QList<int> Fuzzy(const QString &query, int limit = 100) const;
+
+    private:
+        mutable QReadWriteLock lock;
+        QHash<int, QString> texts;              // id -> indexed text
+        QHash<quint64, QVector<int>> postings; // trigram -> sorted ids
+
+        static QVector<quint64> trigrams(const QString &text);
+
+        static QString textOf(const ProxyEntity *ent);
+
+        void update(int id, const QString &text);
+
+        void remove(int id);
+    };
+} // namespace NekoGui
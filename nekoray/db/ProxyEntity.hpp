@@ -4,6 +4,8 @@
 #include "db/traffic/TrafficData.hpp"
 #include "fmt/AbstractBean.hpp"
 
+#include <atomic>
+
 namespace NekoGui_fmt {
     class SocksHttpBean;
 
@@ -20,9 +22,55 @@ namespace NekoGui_fmt {
     class CustomBean;
 
     class ChainBean;
+
+    class BalancerBean;
 }; // namespace NekoGui_fmt
 
 namespace NekoGui {
+    class ProxyEntity;
+
+    // ProxyEntity::bean. A profile loaded from disk parses it from its file on first use,
+    // BeanCache may drop it again once nothing holds it. -> keeps it alive for the
+    // expression, hold Get() or a typed accessor of ProxyEntity for longer. A loaded
+    // bean is handed out without BeanCache's lock.
+    class BeanRef {
+    public:
+        explicit BeanRef(ProxyEntity *owner) : owner(owner) {}
+
+        BeanRef(const BeanRef &) = delete;
+
+        std::shared_ptr<NekoGui_fmt::AbstractBean> operator->() const { return Get(); }
+
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::AbstractBean> Get() const;
+
+        // the bean as T, sharing its ownership; the types are only declared here
+        template<typename T>
+        [[nodiscard]] std::shared_ptr<T> As() const {
+            auto b = Get();
+            return std::shared_ptr<T>(b, (T *) b.get());
+        }
+
+    private:
+        friend class BeanCache;
+        friend class ProxyEntity;
+
+        ProxyEntity *owner;
+        std::shared_ptr<NekoGui_fmt::AbstractBean> bean; // std::atomic_load / atomic_store once shared
+        mutable std::atomic<bool> referenced{false};     // used since BeanCache last looked
+    };
+
+    // What the profile lists show, saved with the profile so listing needs no bean
+    class ProfileMeta : public JsonStore {
+    public:
+        QString name;
+        QString address;
+        QString type;
+
+        ProfileMeta();
+
+        void Update(NekoGui_fmt::AbstractBean *bean);
+    };
+
     class ProxyEntity : public JsonStore {
     public:
         QString type;
@@ -30,47 +78,61 @@ namespace NekoGui {
         int id = -1;
         int gid = 0;
         int latency = 0;
-        std::shared_ptr<NekoGui_fmt::AbstractBean> bean;
+        BeanRef bean{this};
+        ProfileMeta meta;
         std::shared_ptr<NekoGui_traffic::TrafficData> traffic_data = std::make_shared<NekoGui_traffic::TrafficData>("");
 
         QString full_test_report;
 
-        ProxyEntity(NekoGui_fmt::AbstractBean *bean, const QString &type_);
+        // ProfileManager revision of its last add or save, not saved
+        std::atomic<quint64> revision{0};
+
+        // lazy: no bean yet, parsed from fn on first use
+        ProxyEntity(NekoGui_fmt::AbstractBean *bean, const QString &type_, bool lazy = false);
+
+        ~ProxyEntity();
+
+        // Refreshes meta and tells BeanCache the bean is about to be written, done by Save
+        void PrepareSave();
 
         [[nodiscard]] QString DisplayLatency() const;
 
         [[nodiscard]] QColor DisplayLatencyColor() const;
 
-        [[nodiscard]] NekoGui_fmt::ChainBean *ChainBean() const {
-            return (NekoGui_fmt::ChainBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::ChainBean> ChainBean() const {
+            return bean.As<NekoGui_fmt::ChainBean>();
+        };
+
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::BalancerBean> BalancerBean() const {
+            return bean.As<NekoGui_fmt::BalancerBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::SocksHttpBean *SocksHTTPBean() const {
-            return (NekoGui_fmt::SocksHttpBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::SocksHttpBean> SocksHTTPBean() const {
+            return bean.As<NekoGui_fmt::SocksHttpBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::ShadowSocksBean *ShadowSocksBean() const {
-            return (NekoGui_fmt::ShadowSocksBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::ShadowSocksBean> ShadowSocksBean() const {
+            return bean.As<NekoGui_fmt::ShadowSocksBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::VMessBean *VMessBean() const {
-            return (NekoGui_fmt::VMessBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::VMessBean> VMessBean() const {
+            return bean.As<NekoGui_fmt::VMessBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::TrojanVLESSBean *TrojanVLESSBean() const {
-            return (NekoGui_fmt::TrojanVLESSBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::TrojanVLESSBean> TrojanVLESSBean() const {
+            return bean.As<NekoGui_fmt::TrojanVLESSBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::NaiveBean *NaiveBean() const {
-            return (NekoGui_fmt::NaiveBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::NaiveBean> NaiveBean() const {
+            return bean.As<NekoGui_fmt::NaiveBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::QUICBean *QUICBean() const {
-            return (NekoGui_fmt::QUICBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::QUICBean> QUICBean() const {
+            return bean.As<NekoGui_fmt::QUICBean>();
         };
 
-        [[nodiscard]] NekoGui_fmt::CustomBean *CustomBean() const {
-            return (NekoGui_fmt::CustomBean *) bean.get();
+        [[nodiscard]] std::shared_ptr<NekoGui_fmt::CustomBean> CustomBean() const {
+            return bean.As<NekoGui_fmt::CustomBean>();
         };
     };
 } // namespace NekoGui
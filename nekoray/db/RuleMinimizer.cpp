@@ -0,0 +1,282 @@
+#include "RuleMinimizer.hpp"
+
+#include <QHostAddress>
+#include <QSet>
+
+#include <algorithm>
+#include <array>
+#include <map>
+#include <memory>
+
+namespace NekoGui {
+
+    namespace {
+        // entries the minimizer doesn't understand (geosite:, keyword:, regexp:, geoip:...) are only deduplicated
+        struct Literals {
+            QSet<QString> seen;
+            QStringList list;
+
+            bool Add(const QString &item) {
+                if (seen.contains(item)) return false;
+                seen << item;
+                list << item;
+                return true;
+            }
+        };
+
+        // Domain
+
+        // labels are stored reversed, so a suffix rule is an inner node covering its subtree
+        struct DomainNode {
+            bool suffix = false;
+            bool full = false;
+            std::map<QString, std::unique_ptr<DomainNode>> children;
+        };
+
+        struct DomainEntry {
+            bool suffix;
+            QStringList labels;
+        };
+
+        bool parseDomain(const QString &item, DomainEntry &entry) {
+            QString domain;
+            if (item.startsWith("full:")) {
+                entry.suffix = false;
+                domain = item.mid(5);
+            } else if (item.startsWith("domain:")) {
+                entry.suffix = true;
+                domain = item.mid(7);
+            } else if (item.contains(':')) {
+                return false;
+            } else {
+                entry.suffix = true; // same as make_rule, a plain entry is a suffix
+                domain = item;
+            }
+            domain = domain.trimmed().toLower();
+            while (domain.startsWith('.')) domain.remove(0, 1);
+            if (domain.isEmpty()) return false;
+            entry.labels = domain.split('.');
+            std::reverse(entry.labels.begin(), entry.labels.end());
+            return true;
+        }
+
+        bool domainCovered(const DomainNode *root, const DomainEntry &entry) {
+            auto node = root;
+            for (const auto &label: entry.labels) {
+                auto it = node->children.find(label);
+                if (it == node->children.end()) return false;
+                node = it->second.get();
+                if (node->suffix) return true;
+            }
+            return !entry.suffix && node->full;
+        }
+
+        void domainInsert(DomainNode *root, const DomainEntry &entry) {
+            auto node = root;
+            for (const auto &label: entry.labels) {
+                auto &child = node->children[label];
+                if (child == nullptr) child = std::make_unique<DomainNode>();
+                node = child.get();
+            }
+            if (entry.suffix) {
+                node->suffix = true;
+            } else {
+                node->full = true;
+            }
+        }
+
+        void domainEmit(const DomainNode *node, const QString &domain, QStringList &out) {
+            if (node->suffix) {
+                out << "domain:" + domain;
+                return; // everything below is covered
+            }
+            if (node->full) out << "full:" + domain;
+            for (const auto &[label, child]: node->children) {
+                domainEmit(child.get(), domain.isEmpty() ? label : label + "." + domain, out);
+            }
+        }
+
+        // IP
+
+        struct IPNode {
+            bool full = false;
+            std::unique_ptr<IPNode> child[2];
+        };
+
+        struct IPPrefix {
+            bool v6;
+            int length;
+            std::array<quint8, 16> bytes;
+
+            [[nodiscard]] int Bit(int i) const { return (bytes[i / 8] >> (7 - i % 8)) & 1; }
+        };
+
+        struct IPTrie {
+            IPNode v4;
+            IPNode v6;
+
+            IPNode *Root(const IPPrefix &prefix) { return prefix.v6 ? &v6 : &v4; }
+        };
+
+        bool parsePrefix(const QString &item, IPPrefix &prefix) {
+            auto parts = item.trimmed().split('/');
+            if (parts.size() > 2) return false;
+            QHostAddress address;
+            if (!address.setAddress(parts[0])) return false;
+
+            prefix.v6 = address.protocol() == QAbstractSocket::IPv6Protocol;
+            int max = prefix.v6 ? 128 : 32;
+            prefix.length = max;
+            if (parts.size() == 2) {
+                bool ok;
+                prefix.length = parts[1].toInt(&ok);
+                if (!ok || prefix.length < 0 || prefix.length > max) return false;
+            }
+
+            prefix.bytes.fill(0);
+            if (prefix.v6) {
+                auto ip6 = address.toIPv6Address();
+                for (int i = 0; i < 16; i++) prefix.bytes[i] = ip6[i];
+            } else {
+                auto ip4 = address.toIPv4Address();
+                for (int i = 0; i < 4; i++) prefix.bytes[i] = (ip4 >> (24 - i * 8)) & 0xff;
+            }
+            return true;
+        }
+
+        bool ipCovered(const IPNode *root, const IPPrefix &prefix) {
+            auto node = root;
+            for (int i = 0;; i++) {
+                if (node->full) return true;
+                if (i == prefix.length) return false;
+                node = node->child[prefix.Bit(i)].get();
+                if (node == nullptr) return false;
+            }
+        }
+
+        void ipInsert(IPNode *root, const IPPrefix &prefix) {
+            auto node = root;
+            for (int i = 0; i < prefix.length; i++) {
+                if (node->full) return;
+                auto &child = node->child[prefix.Bit(i)];
+                if (child == nullptr) child = std::make_unique<IPNode>();
+                node = child.get();
+            }
+            node->full = true;
+            node->child[0].reset();
+            node->child[1].reset();
+        }
+
+        // two full halves make a full parent
+        void ipMerge(IPNode *node) {
+            if (node->full) return;
+            for (auto &child: node->child) {
+                if (child != nullptr) ipMerge(child.get());
+            }
+            if (node->child[0] && node->child[1] && node->child[0]->full && node->child[1]->full) {
+                node->full = true;
+                node->child[0].reset();
+                node->child[1].reset();
+            }
+        }
+
+        void ipEmit(const IPNode *node, IPPrefix &prefix, QStringList &out) {
+            if (node->full) {
+                QHostAddress address;
+                if (prefix.v6) {
+                    address.setAddress(prefix.bytes.data());
+                } else {
+                    address.setAddress(quint32(prefix.bytes[0]) << 24 | quint32(prefix.bytes[1]) << 16 |
+                                       quint32(prefix.bytes[2]) << 8 | quint32(prefix.bytes[3]));
+                }
+                out << address.toString() + "/" + QString::number(prefix.length);
+                return;
+            }
+            auto i = prefix.length;
+            for (int b = 0; b < 2; b++) {
+                if (node->child[b] == nullptr) continue;
+                if (b) prefix.bytes[i / 8] |= 0x80 >> (i % 8);
+                prefix.length = i + 1;
+                ipEmit(node->child[b].get(), prefix, out);
+                prefix.bytes[i / 8] &= ~(0x80 >> (i % 8));
+            }
+            prefix.length = i;
+        }
+
+        QString shadowed(const RuleList &list, const QString &item, const RuleList &by) {
+            return QStringLiteral("%1: %2 is shadowed by %3").arg(list.name, item, by.name);
+        }
+    } // namespace
+
+    QStringList MinimizeDomainLists(const QList<RuleList> &lists) {
+        QStringList conflicts;
+        std::vector<std::unique_ptr<DomainNode>> tries;
+        std::vector<Literals> literals;
+
+        for (int i = 0; i < lists.size(); i++) {
+            const auto &list = lists[i];
+            tries.push_back(std::make_unique<DomainNode>());
+            literals.emplace_back();
+
+            for (const auto &item: *list.list) {
+                DomainEntry entry;
+                auto parsed = parseDomain(item, entry);
+                int by = -1;
+                for (int j = 0; j < i && by < 0; j++) {
+                    if (parsed ? domainCovered(tries[j].get(), entry) : literals[j].seen.contains(item)) by = j;
+                }
+                if (by >= 0) {
+                    conflicts << shadowed(list, item, lists[by]);
+                } else if (parsed) {
+                    domainInsert(tries[i].get(), entry);
+                } else {
+                    literals[i].Add(item);
+                }
+            }
+
+            QStringList out = literals[i].list;
+            domainEmit(tries[i].get(), {}, out);
+            *list.list = out;
+        }
+        return conflicts;
+    }
+
+    QStringList MinimizeIPLists(const QList<RuleList> &lists) {
+        QStringList conflicts;
+        std::vector<std::unique_ptr<IPTrie>> tries;
+        std::vector<Literals> literals;
+
+        for (int i = 0; i < lists.size(); i++) {
+            const auto &list = lists[i];
+            tries.push_back(std::make_unique<IPTrie>());
+            literals.emplace_back();
+
+            for (const auto &item: *list.list) {
+                IPPrefix prefix;
+                auto parsed = parsePrefix(item, prefix);
+                int by = -1;
+                for (int j = 0; j < i && by < 0; j++) {
+                    if (parsed ? ipCovered(tries[j]->Root(prefix), prefix) : literals[j].seen.contains(item)) by = j;
+                }
+                if (by >= 0) {
+                    conflicts << shadowed(list, item, lists[by]);
+                } else if (parsed) {
+                    ipInsert(tries[i]->Root(prefix), prefix);
+                } else {
+                    literals[i].Add(item);
+                }
+            }
+
+            QStringList out = literals[i].list;
+            for (auto v6: {false, true}) {
+                IPPrefix prefix{v6, 0, {}};
+                auto root = v6 ? &tries[i]->v6 : &tries[i]->v4;
+                ipMerge(root);
+                ipEmit(root, prefix, out);
+            }
+            *list.list = out;
+        }
+        return conflicts;
+    }
+
+} // namespace NekoGui
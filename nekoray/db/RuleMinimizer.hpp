@@ -0,0 +1,22 @@
+#pragma once
+
+#include <QList>
+#include <QStringList>
+
+namespace NekoGui {
+    // A V2Ray format routing list, in the order the core matches them.
+    struct RuleList {
+        QString name;
+        QStringList *list;
+    };
+
+    // Rewrites the lists to their minimal equivalent: duplicates, full: entries
+    // under a domain: suffix and subdomains of another suffix are dropped.
+    // An entry already covered by an earlier list can never match, it is
+    // dropped too and reported. Returns the conflicts.
+    QStringList MinimizeDomainLists(const QList<RuleList> &lists);
+
+    // Same for CIDR lists: contained prefixes are dropped and sibling
+    // prefixes are merged into their parent.
+    QStringList MinimizeIPLists(const QList<RuleList> &lists);
+} // namespace NekoGui
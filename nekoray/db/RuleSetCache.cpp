@@ -0,0 +1,80 @@
+#include "RuleSetCache.hpp"
+#include "main/NekoGui.hpp"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QProcess>
+
+namespace NekoGui {
+
+    RuleSetCache *ruleSetCache = new RuleSetCache;
+
+    RuleSetCache::Entry RuleSetCache::Get(const QStringList &list, bool isIP, const std::function<QJsonObject()> &makeRule) {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(isIP ? "ip\n" : "domain\n");
+        for (const auto &line: list) {
+            hash.addData(line.toUtf8());
+            hash.addData("\n");
+        }
+        auto key = hash.result().toHex();
+
+        QMutexLocker locker(&mutex);
+        if (entries.contains(key) && QFile::exists(entries[key].path)) return entries[key];
+        if (failed.contains(key)) return {};
+
+        QDir().mkpath("rule_sets");
+        auto base = QFileInfo("rule_sets/" + key).absoluteFilePath();
+        Entry entry{"rs-" + key.left(12), base + ".srs"};
+
+        // a previous run may have compiled it already
+        if (!QFile::exists(entry.path)) {
+            if (!QFile::exists(base + ".json")) {
+                auto rule = makeRule();
+                if (rule.isEmpty()) return {};
+                QFile f(base + ".json");
+                if (!f.open(QIODevice::WriteOnly)) return {};
+                f.write(QJsonDocument(QJsonObject{{"version", 1}, {"rules", QJsonArray{rule}}}).toJson(QJsonDocument::Compact));
+                f.close();
+            }
+            if (!Compile(base + ".json", entry.path)) {
+                // a core that can't compile may not read rule-set files at all
+                QFile::remove(base + ".json");
+                failed << key;
+                return {};
+            }
+            Prune();
+        }
+
+        entries[key] = entry;
+        return entry;
+    }
+
+    bool RuleSetCache::Compile(const QString &source, const QString &output) {
+        auto core = FindNekoBoxCoreRealPath();
+        if (!QFile::exists(core)) return false;
+
+        QProcess p;
+        p.start(core, {"rule-set", "compile", "--output", output, source});
+        if (!p.waitForFinished(10000)) {
+            p.kill();
+            p.waitForFinished();
+            return false;
+        }
+        return p.exitStatus() == QProcess::NormalExit && p.exitCode() == 0 && QFile::exists(output);
+    }
+
+    void RuleSetCache::Prune() {
+        QDir dir("rule_sets");
+        auto files = dir.entryInfoList({"*.json"}, QDir::Files, QDir::Time);
+        for (int i = maxFiles; i < files.size(); i++) {
+            auto base = files[i].absolutePath() + "/" + files[i].completeBaseName();
+            QFile::remove(base + ".json");
+            QFile::remove(base + ".srs");
+        }
+    }
+
+} // namespace NekoGui
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QHash>
+#include <QJsonObject>
+#include <QMutex>
+#include <QSet>
+
+#include <functional>
+
+namespace NekoGui {
+    // Large routing lists are moved out of the config into rule-set files under
+    // rule_sets/, named by the hash of their content. The core compiles them to
+    // the binary .srs format once; later builds only look the hash up.
+    class RuleSetCache {
+    public:
+        static constexpr int minEntries = 64; // smaller lists stay inline
+        static constexpr int maxFiles = 32;
+
+        struct Entry {
+            QString tag;
+            QString path; // .srs
+
+            [[nodiscard]] QJsonObject ToJson() const {
+                return {{"type", "local"}, {"tag", tag}, {"format", "binary"}, {"path", path}};
+            }
+        };
+
+        // list is the V2Ray format list the rule is made of, makeRule is only
+        // called on a cache miss. Returns an empty tag on failure, the caller
+        // then keeps the list inline in its route rule.
+        Entry Get(const QStringList &list, bool isIP, const std::function<QJsonObject()> &makeRule);
+
+    private:
+        QMutex mutex;
+        QHash<QByteArray, Entry> entries;
+        QSet<QByteArray> failed; // not compiled, not tried again in this run
+
+        static bool Compile(const QString &source, const QString &output);
+
+        static void Prune();
+    };
+
+    extern RuleSetCache *ruleSetCache;
+} // namespace NekoGui
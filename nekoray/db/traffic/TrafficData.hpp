@@ -17,8 +17,8 @@ namespace NekoGui_traffic {
 
         explicit TrafficData(std::string tag) {
             this->tag = std::move(tag);
-            _add(new configItem("dl", &downlink, itemType::integer64));
-            _add(new configItem("ul", &uplink, itemType::integer64));
+            _add("dl", &downlink, itemType::integer64);
+            _add("ul", &uplink, itemType::integer64);
         };
 
         void Reset() {
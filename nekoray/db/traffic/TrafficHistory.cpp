@@ -0,0 +1,151 @@
+#include "TrafficHistory.hpp"
+
+#include <QDateTime>
+#include <QDir>
+#include <QVector>
+
+#include <algorithm>
+
+namespace NekoGui_traffic {
+
+    TrafficHistory *trafficHistory = new TrafficHistory;
+
+    namespace {
+        constexpr int maxOpenFiles = 64; // mapped files kept around, least recently used are closed
+
+        int totalSamples() {
+            int total = 0;
+            for (auto capacity: TrafficHistory::resolutionCapacity) total += capacity;
+            return total;
+        }
+
+        int ringOffset(int resolution) {
+            int offset = 0;
+            for (int i = 0; i < resolution; i++) offset += TrafficHistory::resolutionCapacity[i];
+            return offset;
+        }
+    } // namespace
+
+    void TrafficHistory::AddTraffic(int profileId, qint64 uplink, qint64 downlink) {
+        if (uplink == 0 && downlink == 0) return;
+        HistorySample delta;
+        delta.uplink = uplink;
+        delta.downlink = downlink;
+        Add(profileId, delta);
+    }
+
+    void TrafficHistory::AddLatency(int profileId, int latency) {
+        HistorySample delta;
+        if (latency > 0) {
+            delta.latency_sum = latency;
+            delta.latency_count = 1;
+        } else {
+            delta.latency_failed = 1;
+        }
+        Add(profileId, delta);
+    }
+
+    void TrafficHistory::Add(int profileId, const HistorySample &delta) {
+        if (profileId < 0) return;
+        QMutexLocker locker(&mutex);
+
+        auto samples = Open(profileId);
+        if (samples == nullptr) return;
+
+        auto now = QDateTime::currentSecsSinceEpoch();
+        for (int r = Second; r <= Hour; r++) {
+            auto bucket = now - now % resolutionSeconds[r];
+            auto &slot = samples[ringOffset(r) + (bucket / resolutionSeconds[r]) % resolutionCapacity[r]];
+            if (slot.time != bucket) slot = HistorySample{bucket}; // the ring wrapped, drop the old bucket
+            slot.uplink += delta.uplink;
+            slot.downlink += delta.downlink;
+            slot.latency_sum += delta.latency_sum;
+            slot.latency_count += delta.latency_count;
+            slot.latency_failed += delta.latency_failed;
+        }
+    }
+
+    QList<HistorySample> TrafficHistory::Query(int profileId, Resolution resolution, qint64 from, qint64 to) {
+        QMutexLocker locker(&mutex);
+        QList<HistorySample> result;
+
+        // a file that isn't mapped yet is only read, a profile without history has no file
+        QVector<HistorySample> unmapped;
+        const HistorySample *ring;
+        if (files.contains(profileId)) {
+            auto &mapped = files[profileId];
+            mapped.lastUse = ++useCounter;
+            ring = mapped.samples + ringOffset(resolution);
+        } else {
+            QFile file(QStringLiteral("history/%1.bin").arg(profileId));
+            if (!file.open(QIODevice::ReadOnly) || file.size() != (qint64) sizeof(HistorySample) * totalSamples()) return result;
+            unmapped.resize(resolutionCapacity[resolution]);
+            auto bytes = (qint64) sizeof(HistorySample) * resolutionCapacity[resolution];
+            if (!file.seek((qint64) sizeof(HistorySample) * ringOffset(resolution)) ||
+                file.read(reinterpret_cast<char *>(unmapped.data()), bytes) != bytes) return result;
+            ring = unmapped.constData();
+        }
+
+        if (to <= 0) to = QDateTime::currentSecsSinceEpoch();
+        // anything older than one ring length was overwritten
+        from = qMax(from, to - (qint64) resolutionSeconds[resolution] * resolutionCapacity[resolution]);
+
+        for (int i = 0; i < resolutionCapacity[resolution]; i++) {
+            if (ring[i].time > 0 && ring[i].time >= from && ring[i].time <= to) result += ring[i];
+        }
+        std::sort(result.begin(), result.end(), [](const HistorySample &a, const HistorySample &b) { return a.time < b.time; });
+        return result;
+    }
+
+    void TrafficHistory::Remove(int profileId) {
+        QMutexLocker locker(&mutex);
+        Close(profileId);
+        QFile::remove(QStringLiteral("history/%1.bin").arg(profileId));
+    }
+
+    HistorySample *TrafficHistory::Open(int profileId) {
+        if (files.contains(profileId)) {
+            auto &mapped = files[profileId];
+            mapped.lastUse = ++useCounter;
+            return mapped.samples;
+        }
+
+        if (files.size() >= maxOpenFiles) {
+            auto lru = files.begin();
+            for (auto it = files.begin(); it != files.end(); ++it) {
+                if (it->lastUse < lru->lastUse) lru = it;
+            }
+            Close(lru.key());
+        }
+
+        QDir().mkpath("history");
+        auto size = (qint64) sizeof(HistorySample) * totalSamples();
+        auto file = new QFile(QStringLiteral("history/%1.bin").arg(profileId));
+        if (!file->open(QIODevice::ReadWrite)) {
+            delete file;
+            return nullptr;
+        }
+        // a file from another layout is started over
+        if (file->size() != size && !(file->resize(0) && file->resize(size))) {
+            delete file;
+            return nullptr;
+        }
+        auto samples = reinterpret_cast<HistorySample *>(file->map(0, size));
+        if (samples == nullptr) {
+            delete file;
+            return nullptr;
+        }
+
+        files[profileId] = MappedFile{file, samples, ++useCounter};
+        return samples;
+    }
+
+    void TrafficHistory::Close(int profileId) {
+        if (!files.contains(profileId)) return;
+        auto mapped = files.take(profileId);
+        mapped.file->unmap(reinterpret_cast<uchar *>(mapped.samples));
+        mapped.file->close();
+        delete mapped.file;
+    }
+
+} // namespace NekoGui_traffic
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <QFile>
+#include <QList>
+#include <QMap>
+#include <QMutex>
+
+namespace NekoGui_traffic {
+    // one bucket of a ring, the ring slot is (time / resolution) % capacity
+    struct HistorySample {
+        qint64 time = 0; // bucket start, unix seconds
+        qint64 uplink = 0;
+        qint64 downlink = 0;
+        qint32 latency_sum = 0; // ms, successful tests only
+        qint16 latency_count = 0;
+        qint16 latency_failed = 0;
+    };
+
+    // Fixed-size per-profile time series in history/<id>.bin, memory-mapped.
+    // Every sample is added to the 1s, 1m and 1h rings at once, so older
+    // resolutions are always rolled up and the file never grows.
+    class TrafficHistory {
+    public:
+        enum Resolution {
+            Second,
+            Minute,
+            Hour,
+        };
+
+        static constexpr int resolutionSeconds[] = {1, 60, 3600};
+        static constexpr int resolutionCapacity[] = {600, 1440, 720}; // 10 min, 1 day, 30 days
+
+        void AddTraffic(int profileId, qint64 uplink, qint64 downlink);
+
+        void AddLatency(int profileId, int latency); // latency < 0: failed
+
+        // empty for a profile that has no history file yet, reading never creates one
+        QList<HistorySample> Query(int profileId, Resolution resolution, qint64 from = 0, qint64 to = 0);
+
+        void Remove(int profileId);
+
+    private:
+        struct MappedFile {
+            QFile *file;
+            HistorySample *samples;
+            qint64 lastUse;
+        };
+
+        QMutex mutex;
+        QMap<int, MappedFile> files;
+        qint64 useCounter = 0;
+
+        // mapped for writing, history/<id>.bin is created when missing
+        HistorySample *Open(int profileId);
+
+        void Close(int profileId);
+
+        void Add(int profileId, const HistorySample &delta);
+    };
+
+    extern TrafficHistory *trafficHistory;
+} // namespace NekoGui_traffic
@@ -1,6 +1,8 @@
 #include "TrafficLooper.hpp"
 
 #include "rpc/gRPC.h"
+#include "db/Database.hpp"
+#include "db/traffic/TrafficHistory.hpp"
 #include "ui/mainwindow_interface.h"
 
 #include <QThread>
@@ -43,14 +45,37 @@ namespace NekoGui_traffic {
         return nullptr;
     }
 
-    QJsonArray TrafficLooper::get_connection_list() {
+    ConnectionDiff TrafficLooper::get_connection_diff() {
+        ConnectionDiff diff;
 #ifndef NKR_NO_GRPC
-        auto str = NekoGui_rpc::defaultClient->ListConnections();
-        QJsonDocument jsonDocument = QJsonDocument::fromJson(str.c_str());
-        return jsonDocument.array();
-#else
-        return QJsonArray{};
+        bool rpcOK = false;
+        auto resp = NekoGui_rpc::defaultClient->ListConnections(&rpcOK, connection_revision);
+        if (!rpcOK) return diff;
+
+        // a restarted core starts counting again
+        diff.full = resp.full() || resp.revision() < connection_revision;
+        connection_revision = resp.revision();
+        for (const auto &record: resp.updated()) {
+            ConnectionData conn;
+            conn.id = record.id().c_str();
+            conn.network = record.network().c_str();
+            conn.inbound = record.inbound().c_str();
+            conn.source = record.source().c_str();
+            conn.destination = record.destination().c_str();
+            conn.domain = record.domain().c_str();
+            conn.process = record.process().c_str();
+            conn.outbound = record.outbound().c_str();
+            conn.rule = record.rule().c_str();
+            conn.upload = record.upload();
+            conn.download = record.download();
+            conn.created_at = record.created_at();
+            diff.updated += conn;
+        }
+        for (const auto &id: resp.closed()) {
+            diff.closed += id.c_str();
+        }
 #endif
+        return diff;
     }
 
     void TrafficLooper::UpdateAll() {
@@ -68,6 +93,7 @@ namespace NekoGui_traffic {
                 data->uplink_rate = diff->uplink_rate;
                 data->downlink_rate = diff->downlink_rate;
             }
+            if (diff != nullptr) trafficHistory->AddTraffic(data->id, diff->uplink, diff->downlink);
         }
         updated[bypass->tag] = update_stats(bypass);
         //
@@ -76,13 +102,33 @@ namespace NekoGui_traffic {
         }
     }
 
+    QList<int> TrafficLooper::UpdateLatency() {
+        QList<int> updated;
+#ifndef NKR_NO_GRPC
+        for (const auto &tag: balancers) {
+            auto resp = NekoGui_rpc::defaultClient->QueryURLTest(tag.toStdString());
+            for (const auto &result: resp.results()) {
+                auto ent = NekoGui::profileManager->GetProfile(balancerMembers.value(result.tag().c_str(), -1));
+                if (ent == nullptr) continue;
+                auto latency = result.delay() > 0 ? result.delay() : -1;
+                if (ent->latency == latency) continue;
+                ent->latency = latency;
+                ent->Save();
+                trafficHistory->AddLatency(ent->id, latency);
+                updated += ent->id;
+            }
+        }
+#endif
+        return updated;
+    }
+
     void TrafficLooper::Loop() {
         elapsedTimer.start();
         while (true) {
-            auto sleep_ms = NekoGui::dataStore->traffic_loop_interval;
+            auto sleep_ms = NekoGui::dataStore->Snapshot()->traffic_loop_interval;
             if (sleep_ms < 500 || sleep_ms > 5000) sleep_ms = 1000;
             QThread::msleep(sleep_ms);
-            if (NekoGui::dataStore->traffic_loop_interval == 0) continue; // user disabled
+            if (NekoGui::dataStore->Snapshot()->traffic_loop_interval == 0) continue; // user disabled
 
             // profile start and stop
             if (!loop_enabled) {
@@ -106,11 +152,12 @@ namespace NekoGui_traffic {
             loop_mutex.lock();
 
             UpdateAll();
+            auto latency_updated = UpdateLatency();
 
             // do conn list update
-            QJsonArray conn_list;
+            ConnectionDiff conn_diff;
             if (NekoGui::dataStore->connection_statistics) {
-                conn_list = get_connection_list();
+                conn_diff = get_connection_diff();
             }
 
             loop_mutex.unlock();
@@ -125,8 +172,11 @@ namespace NekoGui_traffic {
                     if (item->id < 0) continue;
                     m->refresh_proxy_list(item->id);
                 }
+                for (auto id: latency_updated) {
+                    m->refresh_proxy_list(id);
+                }
                 if (NekoGui::dataStore->connection_statistics) {
-                    m->refresh_connection_list(conn_list);
+                    m->refresh_connection_list(conn_diff);
                 }
             });
         }
@@ -3,10 +3,34 @@
 #include <QString>
 #include <QList>
 #include <QMutex>
+#include <QMap>
+#include <QStringList>
 
 #include "TrafficData.hpp"
 
 namespace NekoGui_traffic {
+    struct ConnectionData {
+        QString id;
+        QString network;
+        QString inbound;
+        QString source;
+        QString destination;
+        QString domain;
+        QString process;
+        QString outbound;
+        QString rule;
+        long long upload = 0;
+        long long download = 0;
+        long long created_at = 0;
+    };
+
+    // changes since the last poll, the UI patches its table with it
+    struct ConnectionDiff {
+        bool full = false; // updated is the whole list
+        QList<ConnectionData> updated;
+        QStringList closed;
+    };
+
     class TrafficLooper {
     public:
         bool loop_enabled = false;
@@ -16,8 +40,14 @@ namespace NekoGui_traffic {
         QList<std::shared_ptr<TrafficData>> items;
         TrafficData *proxy = nullptr;
 
+        // urltest outbounds, their probe results are written back to ProxyEntity::latency
+        QStringList balancers;
+        QMap<QString, int> balancerMembers; // outbound tag -> profile id
+
         void UpdateAll();
 
+        QList<int> UpdateLatency();
+
         void Loop();
 
     private:
@@ -25,7 +55,9 @@ namespace NekoGui_traffic {
 
         [[nodiscard]] static TrafficData *update_stats(TrafficData *item);
 
-        [[nodiscard]] static QJsonArray get_connection_list();
+        long long connection_revision = 0;
+
+        [[nodiscard]] ConnectionDiff get_connection_diff();
     };
 
     extern TrafficLooper *trafficLooper;
@@ -7,12 +7,12 @@
 namespace NekoGui_fmt {
     AbstractBean::AbstractBean(int version) {
         this->version = version;
-        _add(new configItem("_v", &this->version, itemType::integer));
-        _add(new configItem("name", &name, itemType::string));
-        _add(new configItem("addr", &serverAddress, itemType::string));
-        _add(new configItem("port", &serverPort, itemType::integer));
-        _add(new configItem("c_cfg", &custom_config, itemType::string));
-        _add(new configItem("c_out", &custom_outbound, itemType::string));
+        _add("_v", &this->version, itemType::integer);
+        _add("name", &name, itemType::string);
+        _add("addr", &serverAddress, itemType::string);
+        _add("port", &serverPort, itemType::integer);
+        _add("c_cfg", &custom_config, itemType::string);
+        _add("c_out", &custom_outbound, itemType::string);
     }
 
     QString AbstractBean::ToNekorayShareLink(const QString &type) {
@@ -4,6 +4,7 @@
 #include <QJsonArray>
 
 #include "main/NekoGui.hpp"
+#include "sys/PortPool.hpp"
 
 namespace NekoGui_fmt {
     struct CoreObjOutboundBuildResult {
@@ -19,6 +20,8 @@ namespace NekoGui_fmt {
         QStringList arguments;
         //
         QString tag;
+        int ready_port = 0; // socks port the external core listens on
+        std::list<std::shared_ptr<NekoGui_sys::PortLease>> port_leases;
         //
         QString error;
         QString config_export;
@@ -0,0 +1,21 @@
+#pragma once
+
+#include "fmt/ChainBean.hpp"
+
+namespace NekoGui_fmt {
+    class BalancerBean : public ChainBean {
+    public:
+        // list: members, empty means every other profile in the group
+        QString url = "";  // empty: test_latency_url
+        int interval = 180; // seconds between probes
+        int tolerance = 50; // ms, switch only when a member is this much faster
+
+        BalancerBean() : ChainBean() {
+            _add("url", &url, itemType::string);
+            _add("interval", &interval, itemType::integer);
+            _add("tolerance", &tolerance, itemType::integer);
+        };
+
+        QString DisplayType() override { return QObject::tr("Balancer"); };
+    };
+} // namespace NekoGui_fmt
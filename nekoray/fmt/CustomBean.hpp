@@ -13,12 +13,12 @@ namespace NekoGui_fmt {
         int socks_port = 0;
 
         CustomBean() : AbstractBean(0) {
-            _add(new configItem("core", &core, itemType::string));
-            _add(new configItem("cmd", &command, itemType::stringList));
-            _add(new configItem("cs", &config_simple, itemType::string));
-            _add(new configItem("cs_suffix", &config_suffix, itemType::string));
-            _add(new configItem("mapping_port", &mapping_port, itemType::integer));
-            _add(new configItem("socks_port", &socks_port, itemType::integer));
+            _add("core", &core, itemType::string);
+            _add("cmd", &command, itemType::stringList);
+            _add("cs", &config_simple, itemType::string);
+            _add("cs_suffix", &config_suffix, itemType::string);
+            _add("mapping_port", &mapping_port, itemType::integer);
+            _add("socks_port", &socks_port, itemType::integer);
         };
 
         QString DisplayType() override {
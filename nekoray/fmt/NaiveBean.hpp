@@ -16,14 +16,14 @@ namespace NekoGui_fmt {
         bool disable_log = false;
 
         NaiveBean() : AbstractBean(0) {
-            _add(new configItem("username", &username, itemType::string));
-            _add(new configItem("password", &password, itemType::string));
-            _add(new configItem("protocol", &protocol, itemType::string));
-            _add(new configItem("extra_headers", &extra_headers, itemType::string));
-            _add(new configItem("sni", &sni, itemType::string));
-            _add(new configItem("certificate", &certificate, itemType::string));
-            _add(new configItem("insecure_concurrency", &insecure_concurrency, itemType::integer));
-            _add(new configItem("disable_log", &disable_log, itemType::boolean));
+            _add("username", &username, itemType::string);
+            _add("password", &password, itemType::string);
+            _add("protocol", &protocol, itemType::string);
+            _add("extra_headers", &extra_headers, itemType::string);
+            _add("sni", &sni, itemType::string);
+            _add("certificate", &certificate, itemType::string);
+            _add("insecure_concurrency", &insecure_concurrency, itemType::integer);
+            _add("disable_log", &disable_log, itemType::boolean);
         };
 
         QString DisplayCoreType() override { return "Naive"; };
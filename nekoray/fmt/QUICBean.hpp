@@ -50,31 +50,31 @@ namespace NekoGui_fmt {
         explicit QUICBean(int _proxy_type) : AbstractBean(0) {
             proxy_type = _proxy_type;
             if (proxy_type == proxy_Hysteria2) {
-                _add(new configItem("obfsPassword", &obfsPassword, itemType::string));
-                _add(new configItem("uploadMbps", &uploadMbps, itemType::integer));
-                _add(new configItem("downloadMbps", &downloadMbps, itemType::integer));
-                _add(new configItem("streamReceiveWindow", &streamReceiveWindow, itemType::integer64));
-                _add(new configItem("connectionReceiveWindow", &connectionReceiveWindow, itemType::integer64));
-                _add(new configItem("disableMtuDiscovery", &disableMtuDiscovery, itemType::boolean));
-                _add(new configItem("hopInterval", &hopInterval, itemType::integer));
-                _add(new configItem("hopPort", &hopPort, itemType::string));
-                _add(new configItem("password", &password, itemType::string));
+                _add("obfsPassword", &obfsPassword, itemType::string);
+                _add("uploadMbps", &uploadMbps, itemType::integer);
+                _add("downloadMbps", &downloadMbps, itemType::integer);
+                _add("streamReceiveWindow", &streamReceiveWindow, itemType::integer64);
+                _add("connectionReceiveWindow", &connectionReceiveWindow, itemType::integer64);
+                _add("disableMtuDiscovery", &disableMtuDiscovery, itemType::boolean);
+                _add("hopInterval", &hopInterval, itemType::integer);
+                _add("hopPort", &hopPort, itemType::string);
+                _add("password", &password, itemType::string);
             } else if (proxy_type == proxy_TUIC) {
-                _add(new configItem("uuid", &uuid, itemType::string));
-                _add(new configItem("password", &password, itemType::string));
-                _add(new configItem("congestionControl", &congestionControl, itemType::string));
-                _add(new configItem("udpRelayMode", &udpRelayMode, itemType::string));
-                _add(new configItem("zeroRttHandshake", &zeroRttHandshake, itemType::boolean));
-                _add(new configItem("heartbeat", &heartbeat, itemType::string));
-                _add(new configItem("uos", &uos, itemType::boolean));
+                _add("uuid", &uuid, itemType::string);
+                _add("password", &password, itemType::string);
+                _add("congestionControl", &congestionControl, itemType::string);
+                _add("udpRelayMode", &udpRelayMode, itemType::string);
+                _add("zeroRttHandshake", &zeroRttHandshake, itemType::boolean);
+                _add("heartbeat", &heartbeat, itemType::string);
+                _add("uos", &uos, itemType::boolean);
             }
-            _add(new configItem("forceExternal", &forceExternal, itemType::boolean));
+            _add("forceExternal", &forceExternal, itemType::boolean);
             // TLS
-            _add(new configItem("allowInsecure", &allowInsecure, itemType::boolean));
-            _add(new configItem("sni", &sni, itemType::string));
-            _add(new configItem("alpn", &alpn, itemType::string));
-            _add(new configItem("caText", &caText, itemType::string));
-            _add(new configItem("disableSni", &disableSni, itemType::boolean));
+            _add("allowInsecure", &allowInsecure, itemType::boolean);
+            _add("sni", &sni, itemType::string);
+            _add("alpn", &alpn, itemType::string);
+            _add("caText", &caText, itemType::string);
+            _add("disableSni", &disableSni, itemType::boolean);
         };
 
         QString DisplayAddress() override {
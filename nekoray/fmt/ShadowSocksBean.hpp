@@ -14,11 +14,11 @@ namespace NekoGui_fmt {
         std::shared_ptr<V2rayStreamSettings> stream = std::make_shared<V2rayStreamSettings>();
 
         ShadowSocksBean() : AbstractBean(0) {
-            _add(new configItem("method", &method, itemType::string));
-            _add(new configItem("pass", &password, itemType::string));
-            _add(new configItem("plugin", &plugin, itemType::string));
-            _add(new configItem("uot", &uot, itemType::integer));
-            _add(new configItem("stream", dynamic_cast<JsonStore *>(stream.get()), itemType::jsonStore));
+            _add("method", &method, itemType::string);
+            _add("pass", &password, itemType::string);
+            _add("plugin", &plugin, itemType::string);
+            _add("uot", &uot, itemType::integer);
+            _add("stream", dynamic_cast<JsonStore *>(stream.get()), itemType::jsonStore);
         };
 
         QString DisplayType() override { return "Shadowsocks"; };
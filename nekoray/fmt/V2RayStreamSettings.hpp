@@ -30,23 +30,23 @@ namespace NekoGui_fmt {
         int multiplex_status = 0;
 
         V2rayStreamSettings() : JsonStore() {
-            _add(new configItem("net", &network, itemType::string));
-            _add(new configItem("sec", &security, itemType::string));
-            _add(new configItem("pac_enc", &packet_encoding, itemType::string));
-            _add(new configItem("path", &path, itemType::string));
-            _add(new configItem("host", &host, itemType::string));
-            _add(new configItem("sni", &sni, itemType::string));
-            _add(new configItem("alpn", &alpn, itemType::string));
-            _add(new configItem("cert", &certificate, itemType::string));
-            _add(new configItem("insecure", &allow_insecure, itemType::boolean));
-            _add(new configItem("h_type", &header_type, itemType::string));
-            _add(new configItem("ed_name", &ws_early_data_name, itemType::string));
-            _add(new configItem("ed_len", &ws_early_data_length, itemType::integer));
-            _add(new configItem("utls", &utlsFingerprint, itemType::string));
-            _add(new configItem("pbk", &reality_pbk, itemType::string));
-            _add(new configItem("sid", &reality_sid, itemType::string));
-            _add(new configItem("spx", &reality_spx, itemType::string));
-            _add(new configItem("mux_s", &multiplex_status, itemType::integer));
+            _add("net", &network, itemType::string);
+            _add("sec", &security, itemType::string);
+            _add("pac_enc", &packet_encoding, itemType::string);
+            _add("path", &path, itemType::string);
+            _add("host", &host, itemType::string);
+            _add("sni", &sni, itemType::string);
+            _add("alpn", &alpn, itemType::string);
+            _add("cert", &certificate, itemType::string);
+            _add("insecure", &allow_insecure, itemType::boolean);
+            _add("h_type", &header_type, itemType::string);
+            _add("ed_name", &ws_early_data_name, itemType::string);
+            _add("ed_len", &ws_early_data_length, itemType::integer);
+            _add("utls", &utlsFingerprint, itemType::string);
+            _add("pbk", &reality_pbk, itemType::string);
+            _add("sid", &reality_sid, itemType::string);
+            _add("spx", &reality_spx, itemType::string);
+            _add("mux_s", &multiplex_status, itemType::integer);
         }
 
         void BuildStreamSettingsSingBox(QJsonObject *outbound);
@@ -54,12 +54,18 @@ namespace NekoGui_fmt {
 
     inline V2rayStreamSettings *GetStreamSettings(AbstractBean *bean) {
         if (bean == nullptr) return nullptr;
-        auto stream_item = bean->_get("stream");
-        if (stream_item != nullptr) {
-            auto stream_store = (JsonStore *) stream_item->ptr;
+        auto stream_store = (JsonStore *) bean->_get("stream");
+        if (stream_store != nullptr) {
             auto stream = (NekoGui_fmt::V2rayStreamSettings *) stream_store;
             return stream;
         }
         return nullptr;
     }
+
+    // keeps the bean it belongs to alive
+    inline std::shared_ptr<V2rayStreamSettings> GetStreamSettings(const std::shared_ptr<AbstractBean> &bean) {
+        auto stream = GetStreamSettings(bean.get());
+        if (stream == nullptr) return nullptr;
+        return {bean, stream};
+    }
 } // namespace NekoGui_fmt
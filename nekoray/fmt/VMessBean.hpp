@@ -13,10 +13,10 @@ namespace NekoGui_fmt {
         std::shared_ptr<V2rayStreamSettings> stream = std::make_shared<V2rayStreamSettings>();
 
         VMessBean() : AbstractBean(0) {
-            _add(new configItem("id", &uuid, itemType::string));
-            _add(new configItem("aid", &aid, itemType::integer));
-            _add(new configItem("sec", &security, itemType::string));
-            _add(new configItem("stream", dynamic_cast<JsonStore *>(stream.get()), itemType::jsonStore));
+            _add("id", &uuid, itemType::string);
+            _add("aid", &aid, itemType::integer);
+            _add("sec", &security, itemType::string);
+            _add("stream", dynamic_cast<JsonStore *>(stream.get()), itemType::jsonStore);
         };
 
         QString DisplayType() override { return "VMess"; };
@@ -4,6 +4,7 @@ import (
 	"context"
 	"errors"
 	"fmt"
+	"sync"
 
 	"grpc_server"
 	"grpc_server/gen"
@@ -12,8 +13,11 @@ import (
 	"github.com/matsuridayo/libneko/neko_log"
 	"github.com/matsuridayo/libneko/speedtest"
 	box "github.com/sagernet/sing-box"
+	"github.com/sagernet/sing-box/adapter"
 	"github.com/sagernet/sing-box/boxapi"
 	boxmain "github.com/sagernet/sing-box/cmd/sing-box"
+	"github.com/sagernet/sing-box/common/urltest"
+	"github.com/sagernet/sing-box/experimental/clashapi/trafficontrol"
 
 	"log"
 
@@ -144,9 +148,163 @@ func (s *server) QueryStats(ctx context.Context, in *gen.QueryStatsReq) (out *ge
 	return
 }
 
-func (s *server) ListConnections(ctx context.Context, in *gen.EmptyReq) (*gen.ListConnectionsResp, error) {
-	out := &gen.ListConnectionsResp{
-		// TODO upstream api
+func (s *server) SelectOutbound(ctx context.Context, in *gen.SelectOutboundReq) (out *gen.ErrorResp, _ error) {
+	var err error
+
+	defer func() {
+		out = &gen.ErrorResp{}
+		if err != nil {
+			out.Error = err.Error()
+		}
+	}()
+
+	if instance == nil {
+		err = errors.New("instance not started")
+		return
+	}
+
+	o, ok := instance.Router().Outbound(in.SelectorTag)
+	if !ok {
+		err = fmt.Errorf("outbound not found: %s", in.SelectorTag)
+		return
+	}
+
+	selector, ok := o.(interface{ SelectOutbound(tag string) bool })
+	if !ok {
+		err = fmt.Errorf("outbound is not a selector: %s", in.SelectorTag)
+		return
+	}
+
+	if !selector.SelectOutbound(in.OutboundTag) {
+		err = fmt.Errorf("selector %s has no outbound %s", in.SelectorTag, in.OutboundTag)
+	}
+
+	return
+}
+
+func (s *server) QueryURLTest(ctx context.Context, in *gen.QueryURLTestReq) (out *gen.QueryURLTestResp, _ error) {
+	out = &gen.QueryURLTestResp{}
+
+	if instance == nil {
+		return
 	}
+
+	o, ok := instance.Router().Outbound(in.Tag)
+	if !ok {
+		return
+	}
+	group, ok := o.(adapter.OutboundGroup)
+	if !ok {
+		return
+	}
+
+	// urltest outbounds keep their results in the clash server's history
+	server, ok := instance.Router().ClashServer().(interface {
+		HistoryStorage() *urltest.HistoryStorage
+	})
+	if !ok || server.HistoryStorage() == nil {
+		return
+	}
+
+	for _, tag := range group.All() {
+		if history := server.HistoryStorage().LoadURLTestHistory(tag); history != nil {
+			out.Results = append(out.Results, &gen.URLTestResult{Tag: tag, Delay: int32(history.Delay)})
+		}
+	}
+
+	return
+}
+
+// connection diffs, each ListConnections call is one revision
+type connectionState struct {
+	record   *gen.ConnectionRecord
+	revision int64
+}
+
+const connectionClosedKeep = 64 // revisions a closed connection is remembered
+
+var connectionMutex sync.Mutex
+var connectionRevision int64
+var connectionOldest int64 = 1
+var connectionStates = make(map[string]*connectionState)
+var connectionClosed = make(map[string]int64)
+
+func (s *server) ListConnections(ctx context.Context, in *gen.ListConnectionsReq) (*gen.ListConnectionsResp, error) {
+	out := &gen.ListConnectionsResp{}
+
+	if instance == nil {
+		return out, nil
+	}
+	server, ok := instance.Router().ClashServer().(interface {
+		TrafficManager() *trafficontrol.Manager
+	})
+	if !ok || server.TrafficManager() == nil {
+		return out, nil
+	}
+
+	connectionMutex.Lock()
+	defer connectionMutex.Unlock()
+
+	connectionRevision++
+	seen := make(map[string]bool)
+	for _, c := range server.TrafficManager().Connections() {
+		id := c.ID.String()
+		seen[id] = true
+
+		record := &gen.ConnectionRecord{
+			Id:          id,
+			Network:     c.Metadata.Network,
+			Inbound:     c.Metadata.Inbound,
+			Source:      c.Metadata.Source.String(),
+			Destination: c.Metadata.Destination.String(),
+			Domain:      c.Metadata.Domain,
+			Outbound:    c.Outbound,
+			Upload:      c.Upload.Load(),
+			Download:    c.Download.Load(),
+			CreatedAt:   c.CreatedAt.Unix(),
+		}
+		if c.Metadata.ProcessInfo != nil {
+			record.Process = c.Metadata.ProcessInfo.ProcessPath
+		}
+		if c.Rule != nil {
+			record.Rule = c.Rule.String()
+		}
+
+		state := connectionStates[id]
+		if state == nil || state.record.Upload != record.Upload || state.record.Download != record.Download {
+			connectionStates[id] = &connectionState{record, connectionRevision}
+		}
+	}
+	for id := range connectionStates {
+		if !seen[id] {
+			delete(connectionStates, id)
+			connectionClosed[id] = connectionRevision
+		}
+	}
+	for id, revision := range connectionClosed {
+		if revision <= connectionRevision-connectionClosedKeep {
+			delete(connectionClosed, id)
+			if revision >= connectionOldest {
+				connectionOldest = revision + 1
+			}
+		}
+	}
+
+	out.Revision = connectionRevision
+	// a revision this run hasn't handed out yet is from before a core restart
+	out.Full = in.SinceRevision <= 0 || in.SinceRevision < connectionOldest-1 || in.SinceRevision >= connectionRevision
+	for _, state := range connectionStates {
+		if out.Full || state.revision > in.SinceRevision {
+			out.Updated = append(out.Updated, state.record)
+		}
+	}
+	if !out.Full {
+		for id, revision := range connectionClosed {
+			if revision > in.SinceRevision {
+				out.Closed = append(out.Closed, id)
+			}
+		}
+	}
+
 	return out, nil
 }
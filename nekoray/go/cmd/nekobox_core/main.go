@@ -23,6 +23,12 @@ func main() {
 		return
 	}
 
+	// a core driven by the headless daemon
+	if len(os.Args) > 1 && os.Args[1] == "run-managed" {
+		runManaged(os.Args[2:])
+		return
+	}
+
 	// sing-box
 	boxmain.Main()
 }
@@ -0,0 +1,90 @@
+package main
+
+import (
+	"bufio"
+	"flag"
+	"fmt"
+	"os"
+	"os/signal"
+	"reflect"
+	"syscall"
+	"unsafe"
+
+	box "github.com/sagernet/sing-box"
+	"github.com/sagernet/sing-box/adapter"
+	boxmain "github.com/sagernet/sing-box/cmd/sing-box"
+)
+
+// printed on stdout once every inbound listens, whatever the log level
+const managedReadyLine = "nekobox_core: ready"
+
+// runManaged is "run" for the headless core manager. A "drain" line on stdin
+// closes the inbounds, so a core that was switched away from takes no new
+// connections while its open ones finish.
+func runManaged(args []string) {
+	flags := flag.NewFlagSet("run-managed", flag.ExitOnError)
+	configPath := flags.String("c", "config.json", "configuration file path")
+	flags.Parse(args)
+
+	content, err := os.ReadFile(*configPath)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, "read config:", err)
+		os.Exit(1)
+	}
+	boxmain.SetDisableColor(true)
+	i, cancel, err := boxmain.Create(content)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, "start:", err)
+		os.Exit(1)
+	}
+	// checked before ready, a core that couldn't drain would keep taking
+	// connections after the manager switched away from it
+	inbounds, err := boxInbounds(i)
+	if err != nil {
+		fmt.Fprintln(os.Stderr, "start:", err)
+		cancel()
+		i.Close()
+		os.Exit(1)
+	}
+	fmt.Println(managedReadyLine)
+
+	go func() {
+		scanner := bufio.NewScanner(os.Stdin)
+		for scanner.Scan() {
+			if scanner.Text() != "drain" {
+				continue
+			}
+			for _, inbound := range inbounds {
+				if err := inbound.Close(); err != nil {
+					fmt.Fprintln(os.Stderr, "drain:", err)
+				}
+			}
+			inbounds = nil
+			fmt.Println("nekobox_core: draining")
+		}
+	}()
+
+	signals := make(chan os.Signal, 1)
+	signal.Notify(signals, os.Interrupt, syscall.SIGTERM)
+	<-signals
+	cancel()
+	i.Close()
+}
+
+// box.Box can't close its inbounds alone, and this sing-box has no public
+// inbound list: Router() only hands out outbounds. The box's own slice is read
+// once, after its type is checked, so a sing-box that moved or renamed it stops
+// the core at start instead of reading the wrong memory. Closing an inbound
+// only closes its listeners, connections it already accepted keep running.
+func boxInbounds(i *box.Box) ([]adapter.Inbound, error) {
+	field := reflect.ValueOf(i).Elem().FieldByName("inbounds")
+	if !field.IsValid() {
+		return nil, fmt.Errorf("box.Box has no inbounds field, can't drain")
+	}
+	want := reflect.TypeOf([]adapter.Inbound(nil))
+	if field.Type() != want {
+		return nil, fmt.Errorf("box.Box inbounds is %s, not %s, can't drain", field.Type(), want)
+	}
+	inbounds := *(*[]adapter.Inbound)(unsafe.Pointer(field.UnsafeAddr()))
+	return append([]adapter.Inbound(nil), inbounds...), nil
+}
@@ -28,7 +28,9 @@ type LibcoreServiceClient interface {
 	Stop(ctx context.Context, in *EmptyReq, opts ...grpc.CallOption) (*ErrorResp, error)
 	Test(ctx context.Context, in *TestReq, opts ...grpc.CallOption) (*TestResp, error)
 	QueryStats(ctx context.Context, in *QueryStatsReq, opts ...grpc.CallOption) (*QueryStatsResp, error)
-	ListConnections(ctx context.Context, in *EmptyReq, opts ...grpc.CallOption) (*ListConnectionsResp, error)
+	ListConnections(ctx context.Context, in *ListConnectionsReq, opts ...grpc.CallOption) (*ListConnectionsResp, error)
+	SelectOutbound(ctx context.Context, in *SelectOutboundReq, opts ...grpc.CallOption) (*ErrorResp, error)
+	QueryURLTest(ctx context.Context, in *QueryURLTestReq, opts ...grpc.CallOption) (*QueryURLTestResp, error)
 }
 
 type libcoreServiceClient struct {
@@ -93,7 +95,7 @@ func (c *libcoreServiceClient) QueryStats(ctx context.Context, in *QueryStatsReq
 	return out, nil
 }
 
-func (c *libcoreServiceClient) ListConnections(ctx context.Context, in *EmptyReq, opts ...grpc.CallOption) (*ListConnectionsResp, error) {
+func (c *libcoreServiceClient) ListConnections(ctx context.Context, in *ListConnectionsReq, opts ...grpc.CallOption) (*ListConnectionsResp, error) {
 	out := new(ListConnectionsResp)
 	err := c.cc.Invoke(ctx, "/libcore.LibcoreService/ListConnections", in, out, opts...)
 	if err != nil {
@@ -102,6 +104,24 @@ func (c *libcoreServiceClient) ListConnections(ctx context.Context, in *EmptyReq
 	return out, nil
 }
 
+func (c *libcoreServiceClient) SelectOutbound(ctx context.Context, in *SelectOutboundReq, opts ...grpc.CallOption) (*ErrorResp, error) {
+	out := new(ErrorResp)
+	err := c.cc.Invoke(ctx, "/libcore.LibcoreService/SelectOutbound", in, out, opts...)
+	if err != nil {
+		return nil, err
+	}
+	return out, nil
+}
+
+func (c *libcoreServiceClient) QueryURLTest(ctx context.Context, in *QueryURLTestReq, opts ...grpc.CallOption) (*QueryURLTestResp, error) {
+	out := new(QueryURLTestResp)
+	err := c.cc.Invoke(ctx, "/libcore.LibcoreService/QueryURLTest", in, out, opts...)
+	if err != nil {
+		return nil, err
+	}
+	return out, nil
+}
+
 // LibcoreServiceServer is the server API for LibcoreService service.
 // All implementations must embed UnimplementedLibcoreServiceServer
 // for forward compatibility
@@ -112,7 +132,9 @@ type LibcoreServiceServer interface {
 	Stop(context.Context, *EmptyReq) (*ErrorResp, error)
 	Test(context.Context, *TestReq) (*TestResp, error)
 	QueryStats(context.Context, *QueryStatsReq) (*QueryStatsResp, error)
-	ListConnections(context.Context, *EmptyReq) (*ListConnectionsResp, error)
+	ListConnections(context.Context, *ListConnectionsReq) (*ListConnectionsResp, error)
+	SelectOutbound(context.Context, *SelectOutboundReq) (*ErrorResp, error)
+	QueryURLTest(context.Context, *QueryURLTestReq) (*QueryURLTestResp, error)
 	mustEmbedUnimplementedLibcoreServiceServer()
 }
 
@@ -138,9 +160,15 @@ func (UnimplementedLibcoreServiceServer) Test(context.Context, *TestReq) (*TestR
 func (UnimplementedLibcoreServiceServer) QueryStats(context.Context, *QueryStatsReq) (*QueryStatsResp, error) {
 	return nil, status.Errorf(codes.Unimplemented, "method QueryStats not implemented")
 }
-func (UnimplementedLibcoreServiceServer) ListConnections(context.Context, *EmptyReq) (*ListConnectionsResp, error) {
+func (UnimplementedLibcoreServiceServer) ListConnections(context.Context, *ListConnectionsReq) (*ListConnectionsResp, error) {
 	return nil, status.Errorf(codes.Unimplemented, "method ListConnections not implemented")
 }
+func (UnimplementedLibcoreServiceServer) SelectOutbound(context.Context, *SelectOutboundReq) (*ErrorResp, error) {
+	return nil, status.Errorf(codes.Unimplemented, "method SelectOutbound not implemented")
+}
+func (UnimplementedLibcoreServiceServer) QueryURLTest(context.Context, *QueryURLTestReq) (*QueryURLTestResp, error) {
+	return nil, status.Errorf(codes.Unimplemented, "method QueryURLTest not implemented")
+}
 func (UnimplementedLibcoreServiceServer) mustEmbedUnimplementedLibcoreServiceServer() {}
 
 // UnsafeLibcoreServiceServer may be embedded to opt out of forward compatibility for this service.
@@ -263,7 +291,7 @@ func _LibcoreService_QueryStats_Handler(srv interface{}, ctx context.Context, de
 }
 
 func _LibcoreService_ListConnections_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
-	in := new(EmptyReq)
+	in := new(ListConnectionsReq)
 	if err := dec(in); err != nil {
 		return nil, err
 	}
@@ -275,7 +303,43 @@ func _LibcoreService_ListConnections_Handler(srv interface{}, ctx context.Contex
 		FullMethod: "/libcore.LibcoreService/ListConnections",
 	}
 	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
-		return srv.(LibcoreServiceServer).ListConnections(ctx, req.(*EmptyReq))
+		return srv.(LibcoreServiceServer).ListConnections(ctx, req.(*ListConnectionsReq))
+	}
+	return interceptor(ctx, in, info, handler)
+}
+
+func _LibcoreService_SelectOutbound_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
+	in := new(SelectOutboundReq)
+	if err := dec(in); err != nil {
+		return nil, err
+	}
+	if interceptor == nil {
+		return srv.(LibcoreServiceServer).SelectOutbound(ctx, in)
+	}
+	info := &grpc.UnaryServerInfo{
+		Server:     srv,
+		FullMethod: "/libcore.LibcoreService/SelectOutbound",
+	}
+	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
+		return srv.(LibcoreServiceServer).SelectOutbound(ctx, req.(*SelectOutboundReq))
+	}
+	return interceptor(ctx, in, info, handler)
+}
+
+func _LibcoreService_QueryURLTest_Handler(srv interface{}, ctx context.Context, dec func(interface{}) error, interceptor grpc.UnaryServerInterceptor) (interface{}, error) {
+	in := new(QueryURLTestReq)
+	if err := dec(in); err != nil {
+		return nil, err
+	}
+	if interceptor == nil {
+		return srv.(LibcoreServiceServer).QueryURLTest(ctx, in)
+	}
+	info := &grpc.UnaryServerInfo{
+		Server:     srv,
+		FullMethod: "/libcore.LibcoreService/QueryURLTest",
+	}
+	handler := func(ctx context.Context, req interface{}) (interface{}, error) {
+		return srv.(LibcoreServiceServer).QueryURLTest(ctx, req.(*QueryURLTestReq))
 	}
 	return interceptor(ctx, in, info, handler)
 }
@@ -315,6 +379,14 @@ var LibcoreService_ServiceDesc = grpc.ServiceDesc{
 			MethodName: "ListConnections",
 			Handler:    _LibcoreService_ListConnections_Handler,
 		},
+		{
+			MethodName: "SelectOutbound",
+			Handler:    _LibcoreService_SelectOutbound_Handler,
+		},
+		{
+			MethodName: "QueryURLTest",
+			Handler:    _LibcoreService_QueryURLTest_Handler,
+		},
 	},
 	Streams:  []grpc.StreamDesc{},
 	Metadata: "libcore.proto",
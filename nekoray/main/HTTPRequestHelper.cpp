@@ -14,16 +14,17 @@ namespace NekoGui_network {
         QNetworkRequest request;
         QNetworkAccessManager accessManager;
         request.setUrl(url);
+        auto ds = NekoGui::dataStore->Snapshot();
         // Set proxy
-        if (NekoGui::dataStore->sub_use_proxy) {
+        if (ds->sub_use_proxy) {
             QNetworkProxy p;
             // Note: sing-box mixed socks5 protocol error
             p.setType(QNetworkProxy::HttpProxy);
             p.setHostName("127.0.0.1");
-            p.setPort(NekoGui::dataStore->inbound_socks_port);
-            if (NekoGui::dataStore->inbound_auth->NeedAuth()) {
-                p.setUser(NekoGui::dataStore->inbound_auth->username);
-                p.setPassword(NekoGui::dataStore->inbound_auth->password);
+            p.setPort(ds->inbound_socks_port);
+            if (ds->inbound_auth->NeedAuth()) {
+                p.setUser(ds->inbound_auth->username);
+                p.setPassword(ds->inbound_auth->password);
             }
             accessManager.setProxy(p);
             if (NekoGui::dataStore->started_id < 0) {
@@ -38,20 +39,20 @@ namespace NekoGui_network {
 #if (QT_VERSION >= QT_VERSION_CHECK(5, 9, 0))
         request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
 #endif
-        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, NekoGui::dataStore->GetUserAgent());
-        if (NekoGui::dataStore->sub_insecure) {
+        request.setHeader(QNetworkRequest::KnownHeaders::UserAgentHeader, ds->GetUserAgent());
+        if (ds->sub_insecure) {
             QSslConfiguration c;
             c.setPeerVerifyMode(QSslSocket::PeerVerifyMode::VerifyNone);
             request.setSslConfiguration(c);
         }
         //
         auto _reply = accessManager.get(request);
-        connect(_reply, &QNetworkReply::sslErrors, _reply, [](const QList<QSslError> &errors) {
+        connect(_reply, &QNetworkReply::sslErrors, _reply, [=](const QList<QSslError> &errors) {
             QStringList error_str;
             for (const auto &err: errors) {
                 error_str << err.errorString();
             }
-            MW_show_log(QStringLiteral("SSL Errors: %1 %2").arg(error_str.join(","), NekoGui::dataStore->sub_insecure ? "(Ignored)" : ""));
+            MW_show_log(QStringLiteral("SSL Errors: %1 %2").arg(error_str.join(","), ds->sub_insecure ? "(Ignored)" : ""));
         });
         // Wait for response
         auto abortTimer = new QTimer;
@@ -8,6 +8,7 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include <QMutex>
 
 #ifdef Q_OS_WIN
 #include "sys/windows/guihelper.h"
@@ -20,42 +21,117 @@
 
 namespace NekoGui_ConfigItem {
 
+    // Schema
+
+    const JsonSchema *JsonSchema::Root() {
+        static auto root = new JsonSchema;
+        return root;
+    }
+
+    const JsonSchema *JsonSchema::Next(const char *name, ptrdiff_t offset, itemType type) const {
+        auto match = [=](const JsonSchema *node) {
+            return node->item.offset == offset && node->item.type == type &&
+                   (node->literal == name || node->item.name == QLatin1String(name));
+        };
+        // lock-free once the type has been constructed, nodes are never freed
+        for (auto node = children.load(std::memory_order_acquire); node != nullptr; node = node->sibling) {
+            if (match(node)) return node;
+        }
+
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        for (auto node = children.load(std::memory_order_acquire); node != nullptr; node = node->sibling) {
+            if (match(node)) return node;
+        }
+        auto node = new JsonSchema;
+        node->parent = this;
+        node->literal = name;
+        node->item = {QString::fromLatin1(name), offset, type};
+        node->sibling = children.load(std::memory_order_relaxed);
+        children.store(node, std::memory_order_release);
+        return node;
+    }
+
+    const QList<configItem> &JsonSchema::Items() const {
+        std::call_once(built, [this] {
+            QList<configItem> all;
+            for (auto node = this; node->parent != nullptr; node = node->parent) {
+                all.prepend(node->item);
+            }
+            for (const auto &item: all) {
+                if (index.contains(item.name)) {
+                    items[index[item.name]] = item;
+                } else {
+                    index[item.name] = items.size();
+                    items << item;
+                }
+            }
+        });
+        return items;
+    }
+
+    const configItem *JsonSchema::Find(const QString &name) const {
+        const auto &all = Items();
+        auto it = index.constFind(name);
+        return it == index.cend() ? nullptr : &all[*it];
+    }
+
     // 添加关联
-    void JsonStore::_add(configItem *item) {
-        _map.insert(item->name, std::shared_ptr<configItem>(item));
+    void JsonStore::_add(const char *name, void *ptr, itemType type) {
+        if (type == itemType::jsonStore) {
+            // lives as long as this store, nothing to hold
+            auto store = (JsonStore *) ptr;
+            _addStore(name, [store] { return std::shared_ptr<JsonStore>(std::shared_ptr<JsonStore>(), store); });
+            return;
+        }
+        _schema = _schema->Next(name, (char *) ptr - (char *) this, type);
+    }
+
+    // only from constructors, so _stores is fixed before anyone else sees this store
+    void JsonStore::_addStore(const char *name, StoreResolver resolve) {
+        _schema = _schema->Next(name, _stores.size(), itemType::jsonStore);
+        _stores << std::move(resolve);
+    }
+
+    void *JsonStore::_ptr(const configItem &item) {
+        if (item.type == itemType::jsonStore) return _store(item).get();
+        return (char *) this + item.offset;
+    }
+
+    std::shared_ptr<JsonStore> JsonStore::_store(const configItem &item) {
+        return _stores.at(item.offset)();
     }
 
     QString JsonStore::_name(void *p) {
-        for (const auto &_item: _map) {
-            if (_item->ptr == p) return _item->name;
+        for (const auto &item: _schema->Items()) {
+            if (_ptr(item) == p) return item.name;
         }
         return {};
     }
 
-    std::shared_ptr<configItem> JsonStore::_get(const QString &name) {
-        // 直接 [] 会设置一个 nullptr ，所以先判断是否存在
-        if (_map.contains(name)) {
-            return _map[name];
-        }
-        return nullptr;
+    void *JsonStore::_get(const QString &name) {
+        auto item = _schema->Find(name);
+        if (item == nullptr) return nullptr;
+        return _ptr(*item);
     }
 
     void JsonStore::_setValue(const QString &name, void *p) {
-        auto item = _get(name);
+        auto item = _schema->Find(name);
         if (item == nullptr) return;
+        auto ptr = _ptr(*item);
 
         switch (item->type) {
             case itemType::string:
-                *(QString *) item->ptr = *(QString *) p;
+                *(QString *) ptr = *(QString *) p;
                 break;
             case itemType::boolean:
-                *(bool *) item->ptr = *(bool *) p;
+                *(bool *) ptr = *(bool *) p;
                 break;
             case itemType::integer:
-                *(int *) item->ptr = *(int *) p;
+                *(int *) ptr = *(int *) p;
                 break;
             case itemType::integer64:
-                *(long long *) item->ptr = *(long long *) p;
+                *(long long *) ptr = *(long long *) p;
                 break;
             // others...
             case stringList:
@@ -67,35 +143,38 @@ namespace NekoGui_ConfigItem {
 
     QJsonObject JsonStore::ToJson(const QStringList &without) {
         QJsonObject object;
-        for (const auto &_item: _map) {
-            auto item = _item.get();
-            if (without.contains(item->name)) continue;
-            switch (item->type) {
+        for (const auto &item: _schema->Items()) {
+            if (without.contains(item.name)) continue;
+            auto ptr = item.type == itemType::jsonStore ? nullptr : _ptr(item); // a store is resolved below
+            switch (item.type) {
                 case itemType::string:
                     // Allow Empty
-                    if (!((QString *) item->ptr)->isEmpty()) {
-                        object.insert(item->name, *(QString *) item->ptr);
+                    if (!((QString *) ptr)->isEmpty()) {
+                        object.insert(item.name, *(QString *) ptr);
                     }
                     break;
                 case itemType::integer:
-                    object.insert(item->name, *(int *) item->ptr);
+                    object.insert(item.name, *(int *) ptr);
                     break;
                 case itemType::integer64:
-                    object.insert(item->name, *(long long *) item->ptr);
+                    object.insert(item.name, *(long long *) ptr);
                     break;
                 case itemType::boolean:
-                    object.insert(item->name, *(bool *) item->ptr);
+                    object.insert(item.name, *(bool *) ptr);
                     break;
                 case itemType::stringList:
-                    object.insert(item->name, QList2QJsonArray<QString>(*(QList<QString> *) item->ptr));
+                    object.insert(item.name, QList2QJsonArray<QString>(*(QList<QString> *) ptr));
                     break;
                 case itemType::integerList:
-                    object.insert(item->name, QList2QJsonArray<int>(*(QList<int> *) item->ptr));
+                    object.insert(item.name, QList2QJsonArray<int>(*(QList<int> *) ptr));
                     break;
-                case itemType::jsonStore:
-                    // _add 时应关联对应 JsonStore 的指针
-                    object.insert(item->name, ((JsonStore *) item->ptr)->ToJson());
+                case itemType::jsonStore: {
+                    // _add 时应关联对应 JsonStore 的指针, 为空时不输出; held while it's written
+                    auto store = _store(item);
+                    if (store == nullptr) break;
+                    object.insert(item.name, store->ToJson());
                     break;
+                }
             }
         }
         return object;
@@ -108,61 +187,62 @@ namespace NekoGui_ConfigItem {
     }
 
     void JsonStore::FromJson(QJsonObject object) {
-        for (const auto &key: object.keys()) {
-            if (_map.count(key) == 0) {
+        for (const auto &item: _schema->Items()) {
+            auto it = object.constFind(item.name);
+            if (it == object.constEnd()) {
                 continue;
             }
 
-            auto value = object[key];
-            auto item = _map[key].get();
-
-            if (item == nullptr)
-                continue; // 故意忽略
+            auto value = *it;
+            auto ptr = item.type == itemType::jsonStore ? nullptr : _ptr(item); // a store is resolved below
 
             // 根据类型修改ptr的内容
-            switch (item->type) {
+            switch (item.type) {
                 case itemType::string:
                     if (value.type() != QJsonValue::String) {
                         continue;
                     }
-                    *(QString *) item->ptr = value.toString();
+                    *(QString *) ptr = value.toString();
                     break;
                 case itemType::integer:
                     if (value.type() != QJsonValue::Double) {
                         continue;
                     }
-                    *(int *) item->ptr = value.toInt();
+                    *(int *) ptr = value.toInt();
                     break;
                 case itemType::integer64:
                     if (value.type() != QJsonValue::Double) {
                         continue;
                     }
-                    *(long long *) item->ptr = value.toDouble();
+                    *(long long *) ptr = value.toDouble();
                     break;
                 case itemType::boolean:
                     if (value.type() != QJsonValue::Bool) {
                         continue;
                     }
-                    *(bool *) item->ptr = value.toBool();
+                    *(bool *) ptr = value.toBool();
                     break;
                 case itemType::stringList:
                     if (value.type() != QJsonValue::Array) {
                         continue;
                     }
-                    *(QList<QString> *) item->ptr = QJsonArray2QListString(value.toArray());
+                    *(QList<QString> *) ptr = QJsonArray2QListString(value.toArray());
                     break;
                 case itemType::integerList:
                     if (value.type() != QJsonValue::Array) {
                         continue;
                     }
-                    *(QList<int> *) item->ptr = QJsonArray2QListInt(value.toArray());
+                    *(QList<int> *) ptr = QJsonArray2QListInt(value.toArray());
                     break;
-                case itemType::jsonStore:
+                case itemType::jsonStore: {
                     if (value.type() != QJsonValue::Object) {
                         continue;
                     }
-                    ((JsonStore *) item->ptr)->FromJson(value.toObject());
+                    auto store = _store(item);
+                    if (store == nullptr) continue;
+                    store->FromJson(value.toObject());
                     break;
+                }
             }
         }
 
@@ -227,62 +307,98 @@ namespace NekoGui {
     // datastore
 
     DataStore::DataStore() : JsonStore() {
-        _add(new configItem("extraCore", dynamic_cast<JsonStore *>(extraCore), itemType::jsonStore));
-        _add(new configItem("inbound_auth", dynamic_cast<JsonStore *>(inbound_auth), itemType::jsonStore));
-
-        _add(new configItem("user_agent2", &user_agent, itemType::string));
-        _add(new configItem("test_url", &test_latency_url, itemType::string));
-        _add(new configItem("test_url_dl", &test_download_url, itemType::string));
-        _add(new configItem("test_dl_timeout", &test_download_timeout, itemType::integer));
-        _add(new configItem("current_group", &current_group, itemType::integer));
-        _add(new configItem("inbound_address", &inbound_address, itemType::string));
-        _add(new configItem("inbound_socks_port", &inbound_socks_port, itemType::integer));
-        _add(new configItem("log_level", &log_level, itemType::string));
-        _add(new configItem("mux_protocol", &mux_protocol, itemType::string));
-        _add(new configItem("mux_concurrency", &mux_concurrency, itemType::integer));
-        _add(new configItem("mux_padding", &mux_padding, itemType::boolean));
-        _add(new configItem("mux_default_on", &mux_default_on, itemType::boolean));
-        _add(new configItem("traffic_loop_interval", &traffic_loop_interval, itemType::integer));
-        _add(new configItem("test_concurrent", &test_concurrent, itemType::integer));
-        _add(new configItem("theme", &theme, itemType::string));
-        _add(new configItem("custom_inbound", &custom_inbound, itemType::string));
-        _add(new configItem("custom_route", &custom_route_global, itemType::string));
-        _add(new configItem("sub_use_proxy", &sub_use_proxy, itemType::boolean));
-        _add(new configItem("remember_id", &remember_id, itemType::integer));
-        _add(new configItem("remember_enable", &remember_enable, itemType::boolean));
-        _add(new configItem("language", &language, itemType::integer));
-        _add(new configItem("spmode2", &remember_spmode, itemType::stringList));
-        _add(new configItem("skip_cert", &skip_cert, itemType::boolean));
-        _add(new configItem("hk_mw", &hotkey_mainwindow, itemType::string));
-        _add(new configItem("hk_group", &hotkey_group, itemType::string));
-        _add(new configItem("hk_route", &hotkey_route, itemType::string));
-        _add(new configItem("hk_spmenu", &hotkey_system_proxy_menu, itemType::string));
-        _add(new configItem("fakedns", &fake_dns, itemType::boolean));
-        _add(new configItem("active_routing", &active_routing, itemType::string));
-        _add(new configItem("mw_size", &mw_size, itemType::string));
-        _add(new configItem("conn_stat", &connection_statistics, itemType::boolean));
-        _add(new configItem("vpn_impl", &vpn_implementation, itemType::integer));
-        _add(new configItem("vpn_mtu", &vpn_mtu, itemType::integer));
-        _add(new configItem("vpn_ipv6", &vpn_ipv6, itemType::boolean));
-        _add(new configItem("vpn_hide_console", &vpn_hide_console, itemType::boolean));
-        _add(new configItem("vpn_strict_route", &vpn_strict_route, itemType::boolean));
-        _add(new configItem("vpn_bypass_process", &vpn_rule_process, itemType::string));
-        _add(new configItem("vpn_bypass_cidr", &vpn_rule_cidr, itemType::string));
-        _add(new configItem("vpn_rule_white", &vpn_rule_white, itemType::boolean));
-        _add(new configItem("check_include_pre", &check_include_pre, itemType::boolean));
-        _add(new configItem("sp_format", &system_proxy_format, itemType::string));
-        _add(new configItem("sub_clear", &sub_clear, itemType::boolean));
-        _add(new configItem("sub_insecure", &sub_insecure, itemType::boolean));
-        _add(new configItem("sub_auto_update", &sub_auto_update, itemType::integer));
-        _add(new configItem("log_ignore", &log_ignore, itemType::stringList));
-        _add(new configItem("start_minimal", &start_minimal, itemType::boolean));
-        _add(new configItem("max_log_line", &max_log_line, itemType::integer));
-        _add(new configItem("splitter_state", &splitter_state, itemType::string));
-        _add(new configItem("utlsFingerprint", &utlsFingerprint, itemType::string));
-        _add(new configItem("core_box_clash_api", &core_box_clash_api, itemType::integer));
-        _add(new configItem("core_box_clash_api_secret", &core_box_clash_api_secret, itemType::string));
-        _add(new configItem("core_box_underlying_dns", &core_box_underlying_dns, itemType::string));
-        _add(new configItem("vpn_internal_tun", &vpn_internal_tun, itemType::boolean));
+        callback_after_load = [this] { Publish(); };
+        callback_before_save = [this] { Publish(); };
+
+        _add("extraCore", dynamic_cast<JsonStore *>(extraCore), itemType::jsonStore);
+        _add("inbound_auth", dynamic_cast<JsonStore *>(inbound_auth), itemType::jsonStore);
+
+        _add("user_agent2", &user_agent, itemType::string);
+        _add("test_url", &test_latency_url, itemType::string);
+        _add("test_url_dl", &test_download_url, itemType::string);
+        _add("test_dl_timeout", &test_download_timeout, itemType::integer);
+        _add("current_group", &current_group, itemType::integer);
+        _add("inbound_address", &inbound_address, itemType::string);
+        _add("inbound_socks_port", &inbound_socks_port, itemType::integer);
+        _add("log_level", &log_level, itemType::string);
+        _add("mux_protocol", &mux_protocol, itemType::string);
+        _add("mux_concurrency", &mux_concurrency, itemType::integer);
+        _add("mux_padding", &mux_padding, itemType::boolean);
+        _add("mux_default_on", &mux_default_on, itemType::boolean);
+        _add("traffic_loop_interval", &traffic_loop_interval, itemType::integer);
+        _add("test_concurrent", &test_concurrent, itemType::integer);
+        _add("theme", &theme, itemType::string);
+        _add("custom_inbound", &custom_inbound, itemType::string);
+        _add("custom_route", &custom_route_global, itemType::string);
+        _add("sub_use_proxy", &sub_use_proxy, itemType::boolean);
+        _add("remember_id", &remember_id, itemType::integer);
+        _add("remember_enable", &remember_enable, itemType::boolean);
+        _add("language", &language, itemType::integer);
+        _add("spmode2", &remember_spmode, itemType::stringList);
+        _add("skip_cert", &skip_cert, itemType::boolean);
+        _add("hk_mw", &hotkey_mainwindow, itemType::string);
+        _add("hk_group", &hotkey_group, itemType::string);
+        _add("hk_route", &hotkey_route, itemType::string);
+        _add("hk_spmenu", &hotkey_system_proxy_menu, itemType::string);
+        _add("fakedns", &fake_dns, itemType::boolean);
+        _add("active_routing", &active_routing, itemType::string);
+        _add("mw_size", &mw_size, itemType::string);
+        _add("conn_stat", &connection_statistics, itemType::boolean);
+        _add("vpn_impl", &vpn_implementation, itemType::integer);
+        _add("vpn_mtu", &vpn_mtu, itemType::integer);
+        _add("vpn_ipv6", &vpn_ipv6, itemType::boolean);
+        _add("vpn_hide_console", &vpn_hide_console, itemType::boolean);
+        _add("vpn_strict_route", &vpn_strict_route, itemType::boolean);
+        _add("vpn_bypass_process", &vpn_rule_process, itemType::string);
+        _add("vpn_bypass_cidr", &vpn_rule_cidr, itemType::string);
+        _add("vpn_rule_white", &vpn_rule_white, itemType::boolean);
+        _add("check_include_pre", &check_include_pre, itemType::boolean);
+        _add("sp_format", &system_proxy_format, itemType::string);
+        _add("sub_clear", &sub_clear, itemType::boolean);
+        _add("sub_insecure", &sub_insecure, itemType::boolean);
+        _add("sub_auto_update", &sub_auto_update, itemType::integer);
+        _add("log_ignore", &log_ignore, itemType::stringList);
+        _add("start_minimal", &start_minimal, itemType::boolean);
+        _add("max_log_line", &max_log_line, itemType::integer);
+        _add("splitter_state", &splitter_state, itemType::string);
+        _add("utlsFingerprint", &utlsFingerprint, itemType::string);
+        _add("core_box_clash_api", &core_box_clash_api, itemType::integer);
+        _add("core_box_clash_api_secret", &core_box_clash_api_secret, itemType::string);
+        _add("core_box_underlying_dns", &core_box_underlying_dns, itemType::string);
+        _add("core_switch_overlap", &core_switch_overlap, itemType::boolean);
+        _add("core_switch_grace", &core_switch_grace, itemType::integer);
+        _add("core_group_selector", &core_group_selector, itemType::boolean);
+        _add("vpn_internal_tun", &vpn_internal_tun, itemType::boolean);
+        _add("port_pool_begin", &port_pool_begin, itemType::integer);
+        _add("port_pool_end", &port_pool_end, itemType::integer);
+    }
+
+    DataStore::~DataStore() {
+        delete extraCore;
+        delete inbound_auth;
+    }
+
+    std::shared_ptr<const DataStore> DataStore::Snapshot() {
+        auto current = std::atomic_load(&snapshot);
+        if (current != nullptr) return current;
+        Publish();
+        return std::atomic_load(&snapshot);
+    }
+
+    void DataStore::Publish() {
+        auto copy = std::make_shared<DataStore>();
+        copy->callback_after_load = nullptr; // a copy doesn't publish
+        copy->callback_before_save = nullptr;
+        copy->FromJsonBytes(ToJsonBytes());
+        if (routing != nullptr) {
+            copy->routing = std::make_unique<Routing>();
+            copy->routing->FromJsonBytes(routing->ToJsonBytes());
+        }
+        copy->core_token = core_token;
+        copy->core_port = core_port;
+        copy->appdataDir = appdataDir;
+        copy->flag_debug = flag_debug;
+        std::atomic_store(&snapshot, std::shared_ptr<const DataStore>(std::move(copy)));
     }
 
     void DataStore::UpdateStartedId(int id) {
@@ -326,26 +442,26 @@ namespace NekoGui {
         }
         if (!Preset::SingBox::DomainStrategy.contains(domain_strategy)) domain_strategy = "";
         if (!Preset::SingBox::DomainStrategy.contains(outbound_domain_strategy)) outbound_domain_strategy = "";
-        _add(new configItem("direct_ip", &this->direct_ip, itemType::string));
-        _add(new configItem("direct_domain", &this->direct_domain, itemType::string));
-        _add(new configItem("proxy_ip", &this->proxy_ip, itemType::string));
-        _add(new configItem("proxy_domain", &this->proxy_domain, itemType::string));
-        _add(new configItem("block_ip", &this->block_ip, itemType::string));
-        _add(new configItem("block_domain", &this->block_domain, itemType::string));
-        _add(new configItem("def_outbound", &this->def_outbound, itemType::string));
-        _add(new configItem("custom", &this->custom, itemType::string));
+        _add("direct_ip", &this->direct_ip, itemType::string);
+        _add("direct_domain", &this->direct_domain, itemType::string);
+        _add("proxy_ip", &this->proxy_ip, itemType::string);
+        _add("proxy_domain", &this->proxy_domain, itemType::string);
+        _add("block_ip", &this->block_ip, itemType::string);
+        _add("block_domain", &this->block_domain, itemType::string);
+        _add("def_outbound", &this->def_outbound, itemType::string);
+        _add("custom", &this->custom, itemType::string);
         //
-        _add(new configItem("remote_dns", &this->remote_dns, itemType::string));
-        _add(new configItem("remote_dns_strategy", &this->remote_dns_strategy, itemType::string));
-        _add(new configItem("direct_dns", &this->direct_dns, itemType::string));
-        _add(new configItem("direct_dns_strategy", &this->direct_dns_strategy, itemType::string));
-        _add(new configItem("domain_strategy", &this->domain_strategy, itemType::string));
-        _add(new configItem("outbound_domain_strategy", &this->outbound_domain_strategy, itemType::string));
-        _add(new configItem("dns_routing", &this->dns_routing, itemType::boolean));
-        _add(new configItem("sniffing_mode", &this->sniffing_mode, itemType::integer));
-        _add(new configItem("use_dns_object", &this->use_dns_object, itemType::boolean));
-        _add(new configItem("dns_object", &this->dns_object, itemType::string));
-        _add(new configItem("dns_final_out", &this->dns_final_out, itemType::string));
+        _add("remote_dns", &this->remote_dns, itemType::string);
+        _add("remote_dns_strategy", &this->remote_dns_strategy, itemType::string);
+        _add("direct_dns", &this->direct_dns, itemType::string);
+        _add("direct_dns_strategy", &this->direct_dns_strategy, itemType::string);
+        _add("domain_strategy", &this->domain_strategy, itemType::string);
+        _add("outbound_domain_strategy", &this->outbound_domain_strategy, itemType::string);
+        _add("dns_routing", &this->dns_routing, itemType::boolean);
+        _add("sniffing_mode", &this->sniffing_mode, itemType::integer);
+        _add("use_dns_object", &this->use_dns_object, itemType::boolean);
+        _add("dns_object", &this->dns_object, itemType::string);
+        _add("dns_final_out", &this->dns_final_out, itemType::string);
     }
 
     QString Routing::DisplayRouting() const {
@@ -380,7 +496,7 @@ namespace NekoGui {
     // NO default extra core
 
     ExtraCore::ExtraCore() : JsonStore() {
-        _add(new configItem("core_map", &this->core_map, itemType::string));
+        _add("core_map", &this->core_map, itemType::string);
     }
 
     QString ExtraCore::Get(const QString &id) const {
@@ -404,8 +520,8 @@ namespace NekoGui {
     }
 
     InboundAuthorization::InboundAuthorization() : JsonStore() {
-        _add(new configItem("user", &this->username, itemType::string));
-        _add(new configItem("pass", &this->password, itemType::string));
+        _add("user", &this->username, itemType::string);
+        _add("pass", &this->password, itemType::string);
     }
 
     bool InboundAuthorization::NeedAuth() const {
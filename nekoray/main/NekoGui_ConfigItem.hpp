@@ -1,5 +1,11 @@
 // DO NOT INCLUDE THIS
 
+#include <QHash>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+
 namespace NekoGui_ConfigItem {
     // config 工具
     enum itemType {
@@ -15,20 +21,48 @@ namespace NekoGui_ConfigItem {
     class configItem {
     public:
         QString name;
-        void *ptr;
+        ptrdiff_t offset; // from the JsonStore, or the index in _stores for itemType::jsonStore
         itemType type;
+    };
 
-        configItem(QString n, void *p, itemType t) {
-            name = std::move(n);
-            ptr = p;
-            type = t;
-        }
+    // The fields a JsonStore registers with _add, shared by all instances.
+    // Every _add steps from one node to the next, so objects of the same type,
+    // which add the same fields in the same order, end on the same node.
+    class JsonSchema {
+    public:
+        static const JsonSchema *Root();
+
+        const JsonSchema *Next(const char *name, ptrdiff_t offset, itemType type) const;
+
+        // the fields up to this node, a later field replaces an earlier one of the same name
+        const QList<configItem> &Items() const;
+
+        const configItem *Find(const QString &name) const;
+
+    private:
+        const JsonSchema *parent = nullptr;
+        const char *literal = nullptr; // fast path for the same call site
+        configItem item;
+
+        mutable std::atomic<JsonSchema *> children{nullptr};
+        JsonSchema *sibling = nullptr;
+
+        mutable std::once_flag built;
+        mutable QList<configItem> items;
+        mutable QHash<QString, int> index;
     };
 
+    class JsonStore;
+
+    // The store of a jsonStore field, held by the caller while it reads or writes it.
+    // Most live as long as their owner, a ProxyEntity parses its bean when it's asked for.
+    using StoreResolver = std::function<std::shared_ptr<JsonStore>()>;
+
     // 可格式化对象
     class JsonStore {
     public:
-        QMap<QString, std::shared_ptr<configItem>> _map;
+        const JsonSchema *_schema = JsonSchema::Root();
+        QList<StoreResolver> _stores; // itemType::jsonStore fields live elsewhere, fixed after construction
 
         std::function<void()> callback_after_load = nullptr;
         std::function<void()> callback_before_save = nullptr;
@@ -45,11 +79,19 @@ namespace NekoGui_ConfigItem {
             fn = std::move(fileName);
         }
 
-        void _add(configItem *item);
+        void _add(const char *name, void *ptr, itemType type);
+
+        // a jsonStore field resolved on every read, see StoreResolver
+        void _addStore(const char *name, StoreResolver resolve);
+
+        // not held for a jsonStore field, use _store
+        void *_ptr(const configItem &item);
+
+        std::shared_ptr<JsonStore> _store(const configItem &item);
 
         QString _name(void *p);
 
-        std::shared_ptr<configItem> _get(const QString &name);
+        void *_get(const QString &name);
 
         void _setValue(const QString &name, void *p);
 
@@ -164,17 +164,34 @@ namespace NekoGui {
         int core_box_clash_api = -9090;
         QString core_box_clash_api_secret = "";
         QString core_box_underlying_dns = "";
+        bool core_switch_overlap = false; // start the new core before stopping the old one
+        int core_switch_grace = 30;       // seconds the old core keeps draining
+        bool core_group_selector = false; // whole group behind a selector, switch without restarting
 
         // Other Core
         ExtraCore *extraCore = new ExtraCore;
+        int port_pool_begin = 20000; // local ports for external cores
+        int port_pool_end = 29999;
 
         // Methods
 
         DataStore();
 
+        ~DataStore();
+
         void UpdateStartedId(int id);
 
         QString GetUserAgent(bool isDefault = false) const;
+
+        // Saved settings and routing as an immutable copy, for other threads.
+        // Take one per operation. Running state is not kept up to date in it.
+        [[nodiscard]] std::shared_ptr<const DataStore> Snapshot();
+
+        // Replaces the snapshot, done on Load and Save. Call it after changing routing.
+        void Publish();
+
+    private:
+        std::shared_ptr<const DataStore> snapshot;
     };
 
     extern DataStore *dataStore;
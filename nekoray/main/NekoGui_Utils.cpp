@@ -1,14 +1,17 @@
 #include "NekoGui_Utils.hpp"
 
 #include "3rdparty/base64.h"
-#include "3rdparty/QThreadCreateThread.hpp"
 
+#include <atomic>
 #include <random>
 
 #include <QApplication>
 #include <QUrlQuery>
 #include <QTcpServer>
+#include <QTcpSocket>
 #include <QTimer>
+#include <QMutex>
+#include <QThread>
 #include <QMessageBox>
 #include <QFile>
 #include <QJsonObject>
@@ -151,6 +154,19 @@ int MkPort() {
     return port;
 }
 
+bool ProbeTcpPort(const QString &host, int port, int timeout_ms) {
+    if (!IsValidPort(port)) return false;
+    auto address = QHostAddress(host);
+    if (address.isNull() || address == QHostAddress::Any || address == QHostAddress::AnyIPv4 || address == QHostAddress::AnyIPv6) {
+        address = QHostAddress::LocalHost;
+    }
+    QTcpSocket s;
+    s.connectToHost(address, port);
+    auto ok = s.waitForConnected(timeout_ms);
+    s.abort();
+    return ok;
+}
+
 QString ReadableSize(const qint64 &size) {
     double sizeAsDouble = size;
     static QStringList measures;
@@ -227,26 +243,110 @@ void ActivateWindow(QWidget *w) {
     w->activateWindow();
 }
 
+namespace {
+    // Tasks posted to one thread: producers push onto a lock-free stack and
+    // only the one that finds the queue idle posts an event, the target
+    // thread then runs the batch in order. While tasks remain another event is
+    // posted before each callback, so a callback that opens a nested event
+    // loop (a modal dialog) doesn't hold back the ones queued after it.
+    class ThreadDispatcher : public QObject {
+    public:
+        ThreadDispatcher *nextDispatcher = nullptr;
+        QThread *target;
+
+        explicit ThreadDispatcher(QThread *thread) : target(thread) {
+            moveToThread(thread);
+        }
+
+        void Post(std::function<void()> callback) {
+            auto task = new Task{std::move(callback), head.load()};
+            while (!head.compare_exchange_weak(task->next, task)) {
+            }
+            if (!pending.exchange(true)) {
+                QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+            }
+        }
+
+    protected:
+        bool event(QEvent *e) override {
+            if (e->type() != QEvent::User) return QObject::event(e);
+            // clear first, so a push after the exchange below posts again
+            pending = false;
+            auto task = head.exchange(nullptr);
+            // the stack is newest first, ready is oldest first
+            Task *batch = nullptr;
+            Task *batchTail = nullptr;
+            while (task != nullptr) {
+                auto next = task->next;
+                task->next = batch;
+                batch = task;
+                if (batchTail == nullptr) batchTail = task;
+                task = next;
+            }
+            if (batch != nullptr) {
+                if (readyTail == nullptr) {
+                    ready = batch;
+                } else {
+                    readyTail->next = batch;
+                }
+                readyTail = batchTail;
+            }
+            // ready is only touched on this thread, a nested loop may take
+            // from it before we get back here
+            while (ready != nullptr) {
+                task = ready;
+                ready = task->next;
+                if (ready == nullptr) {
+                    readyTail = nullptr;
+                } else if (!pending.exchange(true)) {
+                    QCoreApplication::postEvent(this, new QEvent(QEvent::User));
+                }
+                task->callback();
+                delete task;
+            }
+            return true;
+        }
+
+    private:
+        struct Task {
+            std::function<void()> callback;
+            Task *next;
+        };
+
+        std::atomic<Task *> head{nullptr};
+        std::atomic<bool> pending{false};
+        Task *ready = nullptr;
+        Task *readyTail = nullptr;
+    };
+
+    // one per target thread, never removed
+    std::atomic<ThreadDispatcher *> dispatchers{nullptr};
+
+    ThreadDispatcher *dispatcherFor(QThread *thread) {
+        auto first = dispatchers.load();
+        for (auto d = first; d != nullptr; d = d->nextDispatcher) {
+            if (d->target == thread) return d;
+        }
+        static QMutex mutex;
+        QMutexLocker locker(&mutex);
+        first = dispatchers.load();
+        for (auto d = first; d != nullptr; d = d->nextDispatcher) {
+            if (d->target == thread) return d;
+        }
+        auto d = new ThreadDispatcher(thread);
+        d->nextDispatcher = first;
+        dispatchers = d;
+        return d;
+    }
+} // namespace
+
 void runOnUiThread(const std::function<void()> &callback, QObject *parent) {
     // any thread
-    auto *timer = new QTimer();
     auto thread = dynamic_cast<QThread *>(parent);
     if (thread == nullptr) {
-        timer->moveToThread(parent == nullptr ? mainwindow->thread() : parent->thread());
-    } else {
-        timer->moveToThread(thread);
+        thread = parent == nullptr ? QCoreApplication::instance()->thread() : parent->thread();
     }
-    timer->setSingleShot(true);
-    QObject::connect(timer, &QTimer::timeout, [=]() {
-        // main thread
-        callback();
-        timer->deleteLater();
-    });
-    QMetaObject::invokeMethod(timer, "start", Qt::QueuedConnection, Q_ARG(int, 0));
-}
-
-void runOnNewThread(const std::function<void()> &callback) {
-    createQThread(callback)->start();
+    dispatcherFor(thread)->Post(callback);
 }
 
 void setTimeout(const std::function<void()> &callback, QObject *obj, int timeout) {
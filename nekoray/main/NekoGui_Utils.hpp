@@ -133,6 +133,9 @@ inline QString DisplayAddress(QString serverAddress, int serverPort) {
 
 int MkPort();
 
+// true if something accepts TCP connections on host:port within timeout_ms
+bool ProbeTcpPort(const QString &host, int port, int timeout_ms = 50);
+
 QString DisplayTime(long long time, int formatType = 0);
 
 QString ReadableSize(const qint64 &size);
@@ -159,8 +162,6 @@ void ActivateWindow(QWidget *w);
 
 void runOnUiThread(const std::function<void()> &callback, QObject *parent = nullptr);
 
-void runOnNewThread(const std::function<void()> &callback);
-
 template<typename EMITTER, typename SIGNAL, typename RECEIVER, typename ReceiverFunc>
 inline void connectOnce(EMITTER *emitter, SIGNAL signal, RECEIVER *receiver, ReceiverFunc f,
                         Qt::ConnectionType connectionType = Qt::AutoConnection) {
@@ -199,6 +199,7 @@ int main(int argc, char* argv[]) {
     if (!isLoaded) {
         NekoGui::dataStore->routing->Save();
     }
+    NekoGui::dataStore->Publish();
 
     // Translate
     QString locale;
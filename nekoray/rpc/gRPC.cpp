@@ -255,18 +255,42 @@ namespace NekoGui_rpc {
         }
     }
 
-    std::string Client::ListConnections() {
-        libcore::EmptyReq request;
+    libcore::ListConnectionsResp Client::ListConnections(bool *rpcOK, long long sinceRevision) {
+        libcore::ListConnectionsReq request;
+        request.set_since_revision(sinceRevision);
+
         libcore::ListConnectionsResp reply;
         auto status = default_grpc_channel->Call("ListConnections", request, &reply, 500);
+        *rpcOK = status == QNetworkReply::NoError;
+        return reply;
+    }
+
+    QString Client::SelectOutbound(bool *rpcOK, const std::string &selector, const std::string &outbound) {
+        libcore::SelectOutboundReq request;
+        request.set_selector_tag(selector);
+        request.set_outbound_tag(outbound);
+
+        libcore::ErrorResp reply;
+        auto status = default_grpc_channel->Call("SelectOutbound", request, &reply, 500);
 
         if (status == QNetworkReply::NoError) {
-            return reply.nekoray_connections_json();
+            *rpcOK = true;
+            return {reply.error().c_str()};
         } else {
+            NOT_OK
             return "";
         }
     }
 
+    libcore::QueryURLTestResp Client::QueryURLTest(const std::string &tag) {
+        libcore::QueryURLTestReq request;
+        request.set_tag(tag);
+
+        libcore::QueryURLTestResp reply;
+        default_grpc_channel->Call("QueryURLTest", request, &reply, 500);
+        return reply;
+    }
+
     //
 
     libcore::TestResp Client::Test(bool *rpcOK, const libcore::TestReq &request) {
@@ -26,7 +26,11 @@ namespace NekoGui_rpc {
 
         long long QueryStats(const std::string &tag, const std::string &direct);
 
-        std::string ListConnections();
+        libcore::ListConnectionsResp ListConnections(bool *rpcOK, long long sinceRevision);
+
+        QString SelectOutbound(bool *rpcOK, const std::string &selector, const std::string &outbound);
+
+        libcore::QueryURLTestResp QueryURLTest(const std::string &tag);
 
         libcore::TestResp Test(bool *rpcOK, const libcore::TestReq &request);
 
@@ -2,10 +2,12 @@
 #include "fmt/includes.h"
 #include "fmt/Preset.hpp"
 #include "main/HTTPRequestHelper.hpp"
+#include "sys/Executor.hpp"
 
 #include "GroupUpdater.hpp"
 
 #include <QInputDialog>
+#include <QSet>
 #include <QUrlQuery>
 
 #ifndef NKR_NO_YAML
@@ -20,7 +22,7 @@ namespace NekoGui_sub {
 
     void RawUpdater_FixEnt(const std::shared_ptr<NekoGui::ProxyEntity> &ent) {
         if (ent == nullptr) return;
-        auto stream = NekoGui_fmt::GetStreamSettings(ent->bean.get());
+        auto stream = NekoGui_fmt::GetStreamSettings(ent->bean.Get());
         if (stream == nullptr) return;
         // 1. "security"
         if (stream->security == "none" || stream->security == "0" || stream->security == "false") {
@@ -143,8 +145,7 @@ namespace NekoGui_sub {
         // Fix
         if (needFix) RawUpdater_FixEnt(ent);
 
-        // End
-        NekoGui::profileManager->AddProfile(ent, gid_add_to);
+        // End, added together by GroupUpdater
         updated_order += ent;
     }
 
@@ -450,7 +451,6 @@ namespace NekoGui_sub {
                 }
 
                 if (needFix) RawUpdater_FixEnt(ent);
-                NekoGui::profileManager->AddProfile(ent, gid_add_to);
                 updated_order += ent;
             }
         } catch (const YAML::Exception &ex) {
@@ -483,7 +483,7 @@ namespace NekoGui_sub {
             if (items.indexOf(a) == 1) createNewGroup = true;
         }
 
-        runOnNewThread([=] {
+        NekoGui_sys::executor->Submit([=] {
             auto gid = _sub_gid;
             if (createNewGroup) {
                 auto group = NekoGui::ProfileManager::NewGroup();
@@ -496,14 +496,13 @@ namespace NekoGui_sub {
             Update(str, gid, asURL);
             emit asyncUpdateCallback(gid);
             if (finish != nullptr) finish();
-        });
+        }, NekoGui_sys::TaskClass::Subscription);
     }
 
     void GroupUpdater::Update(const QString &_str, int _sub_gid, bool _not_sub_as_url) {
         // 创建 rawUpdater
         NekoGui::dataStore->imported_count = 0;
         auto rawUpdater = std::make_unique<RawUpdater>();
-        rawUpdater->gid_add_to = _sub_gid;
 
         // 准备
         QString sub_user_info;
@@ -537,9 +536,21 @@ namespace NekoGui_sub {
         QList<std::shared_ptr<NekoGui::ProxyEntity>> update_del;  // 更新前后都有的，需要删除的新配置
         QList<std::shared_ptr<NekoGui::ProxyEntity>> update_keep; // 更新前后都有的，被保留的旧配置
 
-        // 订阅解析前
+        // 解析, 不持有写锁
+        rawUpdater->update(content);
+
+        // readers see the whole update at once
+        NekoGui::profileManager->BeginUpdate();
+        if (group != nullptr) in = group->Profiles();
+
+        // 添加 profile, 失败时什么都不改
+        if (!NekoGui::profileManager->AddProfiles(rawUpdater->updated_order, _sub_gid)) {
+            NekoGui::profileManager->EndUpdate();
+            MW_show_log(QObject::tr("Failed to save %1 imported profiles, nothing was changed.").arg(rawUpdater->updated_order.count()));
+            return;
+        }
+
         if (group != nullptr) {
-            in = group->Profiles();
             group->sub_last_update = QDateTime::currentMSecsSinceEpoch() / 1000;
             group->info = sub_user_info;
             group->order.clear();
@@ -547,16 +558,11 @@ namespace NekoGui_sub {
             //
             if (NekoGui::dataStore->sub_clear) {
                 MW_show_log(QObject::tr("Clearing servers..."));
-                for (const auto &profile: in) {
-                    NekoGui::profileManager->DeleteProfile(profile->id);
-                }
+                QList<int> ids;
+                for (const auto &profile: in) ids << profile->id;
+                NekoGui::profileManager->DeleteProfiles(ids);
             }
-        }
-
-        // 解析并添加 profile
-        rawUpdater->update(content);
 
-        if (group != nullptr) {
             out_all = group->Profiles();
 
             QString change_text;
@@ -597,11 +603,13 @@ namespace NekoGui_sub {
                 group->Save();
 
                 // cleanup
+                QSet<int> kept;
+                for (auto id: group->order) kept << id;
+                QList<int> ids;
                 for (const auto &ent: out_all) {
-                    if (!group->order.contains(ent->id)) {
-                        NekoGui::profileManager->DeleteProfile(ent->id);
-                    }
+                    if (!kept.contains(ent->id)) ids << ent->id;
                 }
+                NekoGui::profileManager->DeleteProfiles(ids);
 
                 change_text = "\n" + QObject::tr("Added %1 profiles:\n%2\nDeleted %3 Profiles:\n%4")
                                          .arg(only_out.length())
@@ -611,9 +619,11 @@ namespace NekoGui_sub {
                 if (only_out.length() + only_in.length() == 0) change_text = QObject::tr("Nothing");
             }
 
+            NekoGui::profileManager->EndUpdate();
             MW_show_log("<<<<<<<< " + QObject::tr("Change of %1:").arg(group->name) + "\n" + change_text);
             MW_dialog_message("SubUpdater", "finish-dingyue");
         } else {
+            NekoGui::profileManager->EndUpdate();
             NekoGui::dataStore->imported_count = rawUpdater->updated_order.count();
             MW_dialog_message("SubUpdater", "finish");
         }
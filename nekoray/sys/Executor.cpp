@@ -0,0 +1,133 @@
+#include "Executor.hpp"
+
+#include "3rdparty/QThreadCreateThread.hpp"
+
+namespace NekoGui_sys {
+
+    namespace {
+        thread_local int currentWorker = -1;
+    }
+
+    void Executor::grow(int count) {
+        static QMutex growMutex;
+        QMutexLocker locker(&growMutex);
+        count = qMin(count, maxWorkers);
+        for (int i = workerCount; i < count; i++) {
+            createQThread([this, i] { run(i); })->start();
+            workerCount = i + 1;
+        }
+    }
+
+    void Executor::SetLimit(TaskClass cls, int limit) {
+        {
+            QMutexLocker locker(&classMutex);
+            limits[int(cls)] = limit;
+        }
+        grow(qMax(QThread::idealThreadCount(), 4));
+        if (limit > 0) grow(limit + 2);
+        admit(cls);
+    }
+
+    void Executor::Submit(std::function<void()> fn, TaskClass cls, TaskPriority priority) {
+        Task task{std::move(fn), cls, priority};
+        if (cls == TaskClass::LongRunning) {
+            createQThread(std::move(task.fn))->start();
+            return;
+        }
+        if (workerCount == 0) grow(qMax(QThread::idealThreadCount(), 4));
+
+        {
+            QMutexLocker locker(&classMutex);
+            auto limit = limits[int(cls)];
+            if (limit > 0 && running[int(cls)] >= limit) {
+                pending[int(cls)][int(priority)].push_back(std::move(task));
+                return;
+            }
+            running[int(cls)]++;
+        }
+        enqueue(std::move(task));
+    }
+
+    void Executor::enqueue(Task task) {
+        // spawned from a worker: keep it local
+        auto self = currentWorker;
+        if (self < 0) self = int(nextWorker++ % unsigned(workerCount));
+        {
+            auto &worker = workers[self];
+            QMutexLocker locker(&worker.mutex);
+            worker.queues[int(task.priority)].push_back(std::move(task));
+        }
+        queued++;
+        QMutexLocker locker(&sleepMutex);
+        wake.wakeOne();
+    }
+
+    bool Executor::take(int self, Task &task) {
+        int count = workerCount;
+        for (int priority = int(TaskPriority::Count) - 1; priority >= 0; priority--) {
+            {
+                auto &own = workers[self];
+                QMutexLocker locker(&own.mutex);
+                auto &queue = own.queues[priority];
+                if (!queue.empty()) {
+                    task = std::move(queue.back());
+                    queue.pop_back();
+                    return true;
+                }
+            }
+            for (int i = 1; i < count; i++) {
+                auto &victim = workers[(self + i) % count];
+                QMutexLocker locker(&victim.mutex);
+                auto &queue = victim.queues[priority];
+                if (!queue.empty()) {
+                    task = std::move(queue.front());
+                    queue.pop_front();
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void Executor::run(int self) {
+        currentWorker = self;
+        forever {
+            Task task;
+            if (queued > 0 && take(self, task)) {
+                queued--;
+                task.fn();
+                finished(task.cls);
+                continue;
+            }
+            QMutexLocker locker(&sleepMutex);
+            if (queued == 0) wake.wait(&sleepMutex);
+        }
+    }
+
+    void Executor::finished(TaskClass cls) {
+        {
+            QMutexLocker locker(&classMutex);
+            running[int(cls)]--;
+        }
+        admit(cls);
+    }
+
+    void Executor::admit(TaskClass cls) {
+        forever {
+            Task next;
+            {
+                QMutexLocker locker(&classMutex);
+                auto limit = limits[int(cls)];
+                if (limit > 0 && running[int(cls)] >= limit) return;
+                int priority = int(TaskPriority::Count) - 1;
+                while (priority >= 0 && pending[int(cls)][priority].empty()) priority--;
+                if (priority < 0) return;
+                next = std::move(pending[int(cls)][priority].front());
+                pending[int(cls)][priority].pop_front();
+                running[int(cls)]++;
+            }
+            enqueue(std::move(next));
+        }
+    }
+
+} // namespace NekoGui_sys
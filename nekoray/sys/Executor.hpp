@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <QMutex>
+#include <QWaitCondition>
+
+namespace NekoGui_sys {
+    // Concurrency of each class is bounded separately, see Executor::SetLimit
+    enum class TaskClass {
+        Default,
+        Test,
+        Subscription,
+        IO,
+        LongRunning, // loops and blocking processes, always gets its own thread
+        Count,
+    };
+
+    enum class TaskPriority {
+        Low,
+        Normal,
+        High,
+        Count,
+    };
+
+    // Cooperative: tasks check it between steps. Copies share the state.
+    class CancelToken {
+    public:
+        void Cancel() { *cancelled = true; }
+
+        [[nodiscard]] bool IsCancelled() const { return *cancelled; }
+
+    private:
+        std::shared_ptr<std::atomic<bool>> cancelled = std::make_shared<std::atomic<bool>>(false);
+    };
+
+    // Process-wide work-stealing thread pool. Each worker pops its own deque
+    // newest first and steals the oldest task of the others when idle, higher
+    // priorities first. Tasks over their class limit wait outside the deques.
+    class Executor {
+    public:
+        void Submit(std::function<void()> task, TaskClass cls = TaskClass::Default, TaskPriority priority = TaskPriority::Normal);
+
+        // <= 0 is unbounded. The pool grows so a full class never takes every worker.
+        void SetLimit(TaskClass cls, int limit);
+
+    private:
+        struct Task {
+            std::function<void()> fn;
+            TaskClass cls;
+            TaskPriority priority;
+        };
+
+        struct Worker {
+            QMutex mutex;
+            std::deque<Task> queues[int(TaskPriority::Count)];
+        };
+
+        static constexpr int maxWorkers = 64;
+
+        // fixed slots, so workers can be added while others steal
+        Worker workers[maxWorkers];
+        std::atomic<int> workerCount{0};
+        std::atomic<unsigned> nextWorker{0};
+        std::atomic<int> queued{0};
+
+        QMutex sleepMutex;
+        QWaitCondition wake;
+
+        // class admission
+        QMutex classMutex;
+        // Test is set per run from test_concurrent, subscriptions hit the same few hosts
+        int limits[int(TaskClass::Count)] = {0, 0, 2, 0, 0};
+        int running[int(TaskClass::Count)] = {};
+        std::deque<Task> pending[int(TaskClass::Count)][int(TaskPriority::Count)];
+
+        // workers are started on first use
+        void grow(int count);
+
+        void enqueue(Task task);
+
+        bool take(int self, Task &task);
+
+        void run(int self);
+
+        void finished(TaskClass cls);
+
+        // moves pending tasks of cls into the deques while under its limit
+        void admit(TaskClass cls);
+    };
+
+    inline Executor *executor = new Executor;
+} // namespace NekoGui_sys
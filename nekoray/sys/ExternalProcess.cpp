@@ -5,12 +5,24 @@
 #include <QDir>
 #include <QApplication>
 #include <QElapsedTimer>
+#include <QThread>
 
 namespace NekoGui_sys {
 
     ExternalProcess::ExternalProcess() : QProcess() {
         // qDebug() << "[Debug] ExternalProcess()" << this << running_ext;
         this->env = QProcessEnvironment::systemEnvironment().toStringList();
+        connect(this, &QProcess::stateChanged, this, [&](QProcess::ProcessState state) {
+            if (state == QProcess::NotRunning && started) {
+                // it may have failed to listen on a port taken since the lease;
+                // checked before exited is set, so a retry leases another one
+                if (!killed) {
+                    for (const auto &lease: port_leases) portPool->Recheck(lease->port);
+                }
+                exited = 1;
+                port_leases.clear();
+            }
+        });
     }
 
     ExternalProcess::~ExternalProcess() {
@@ -66,6 +78,19 @@ namespace NekoGui_sys {
         }
     }
 
+    bool ExternalProcess::WaitForReady(int timeout_ms) {
+        if (ready_port <= 0) return true; // nothing to probe
+
+        QElapsedTimer timer;
+        timer.start();
+        while (timer.elapsed() < timeout_ms) {
+            if (exited) return false;
+            if (ProbeTcpPort("127.0.0.1", ready_port)) return true;
+            QThread::msleep(10);
+        }
+        return false;
+    }
+
     //
 
     QElapsedTimer coreRestartTimer;
@@ -3,6 +3,8 @@
 #include <memory>
 #include <QProcess>
 
+#include "PortPool.hpp"
+
 namespace NekoGui_sys {
     class ExternalProcess : public QProcess {
     public:
@@ -13,6 +15,12 @@ namespace NekoGui_sys {
 
         bool managed = true; // MW_dialog_message
 
+        // readiness probe: the local port the process listens on, 0 for none
+        int ready_port = 0;
+
+        // returned to the pool when the process exits
+        std::list<std::shared_ptr<PortLease>> port_leases;
+
         ExternalProcess();
         ~ExternalProcess();
 
@@ -22,10 +30,17 @@ namespace NekoGui_sys {
 
         void Kill();
 
+        // call from any thread other than the owner, returns false on timeout or exit
+        bool WaitForReady(int timeout_ms);
+
+        [[nodiscard]] bool Exited() const { return exited; }
+
     protected:
         bool started = false;
         bool killed = false;
         bool crashed = false;
+
+        QAtomicInt exited;
     };
 
     class CoreProcess : public ExternalProcess {
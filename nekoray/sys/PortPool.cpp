@@ -0,0 +1,61 @@
+#include "PortPool.hpp"
+#include "main/NekoGui.hpp"
+
+#include <QTcpServer>
+#include <QUdpSocket>
+
+namespace NekoGui_sys {
+
+    namespace {
+        // the external cores listen on both
+        bool canBind(int port) {
+            QTcpServer tcp;
+            if (!tcp.listen(QHostAddress::LocalHost, port)) return false;
+            QUdpSocket udp;
+            return udp.bind(QHostAddress::LocalHost, port);
+        }
+    } // namespace
+
+    std::shared_ptr<PortLease> PortPool::Lease() {
+        auto begin = NekoGui::dataStore->port_pool_begin;
+        auto end = NekoGui::dataStore->port_pool_end;
+        if (!IsValidPort(begin) || !IsValidPort(end) || begin > end) return nullptr;
+
+        QMutexLocker locker(&mutex);
+        if (begin != rangeBegin || end != rangeEnd) {
+            rangeBegin = begin;
+            rangeEnd = end;
+            taken.clear();
+        }
+        auto size = end - begin + 1;
+        if (cursor < begin || cursor > end) cursor = begin;
+        // round-robin, so a port just released (maybe in TIME_WAIT) is the last to come back
+        for (int i = 0; i < size; i++) {
+            auto port = cursor;
+            cursor = cursor == end ? begin : cursor + 1;
+            if (leased.contains(port) || taken.contains(port)) continue;
+            leased.insert(port);
+            return std::make_shared<PortLease>(this, port);
+        }
+        return nullptr;
+    }
+
+    void PortPool::Release(int port) {
+        QMutexLocker locker(&mutex);
+        leased.remove(port);
+    }
+
+    bool PortPool::Recheck(int port) {
+        // only on failure, never on the lease path
+        if (canBind(port)) return true;
+        QMutexLocker locker(&mutex);
+        taken.insert(port);
+        return false;
+    }
+
+    int PortPool::LeasedCount() {
+        QMutexLocker locker(&mutex);
+        return leased.size();
+    }
+
+} // namespace NekoGui_sys
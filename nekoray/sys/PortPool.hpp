@@ -0,0 +1,49 @@
+#pragma once
+
+#include <memory>
+#include <QMutex>
+#include <QSet>
+
+namespace NekoGui_sys {
+    class PortLease;
+
+    // Hands out local ports from [port_pool_begin, port_pool_end] without binding,
+    // a port stays reserved until its last PortLease is destroyed. A port another
+    // program holds is only found when a process fails to listen on it, Recheck
+    // then keeps it out of later leases.
+    class PortPool {
+    public:
+        // nullptr when the range is exhausted
+        std::shared_ptr<PortLease> Lease();
+
+        void Release(int port);
+
+        // after a process using port exited unexpectedly: returns false and skips
+        // the port until the range changes when something else holds it
+        bool Recheck(int port);
+
+        [[nodiscard]] int LeasedCount();
+
+    private:
+        QMutex mutex;
+        QSet<int> leased;
+        QSet<int> taken; // by other programs
+        int cursor = 0;
+        int rangeBegin = 0;
+        int rangeEnd = 0;
+    };
+
+    class PortLease {
+    public:
+        const int port;
+
+        explicit PortLease(PortPool *pool, int port) : port(port), pool(pool) {}
+
+        ~PortLease() { pool->Release(port); }
+
+    private:
+        PortPool *pool;
+    };
+
+    inline PortPool *portPool = new PortPool;
+} // namespace NekoGui_sys
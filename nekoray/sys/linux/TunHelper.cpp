@@ -0,0 +1,140 @@
+#include "TunHelper.hpp"
+#include "LinuxCap.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QStandardPaths>
+
+#include <unistd.h>
+
+#define HELPER_CAPS "cap_net_admin,cap_net_bind_service,cap_net_raw=ep"
+
+TunHelperClient::TunHelperClient(QObject *parent) : QObject(parent) {}
+
+TunHelperClient::~TunHelperClient() {
+    if (IsConnected()) Command("quit");
+    disconnectHelper();
+}
+
+QString TunHelperClient::HelperPath() {
+    return QCoreApplication::applicationDirPath() + "/nekobox_tun_helper";
+}
+
+bool TunHelperClient::IsConnected() const {
+    return m_socket != nullptr && m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+bool TunHelperClient::Connect() {
+    if (IsConnected()) return true;
+    disconnectHelper();
+
+    auto helper = HelperPath();
+    if (!QFile::exists(helper)) return false;
+
+    // the only polkit prompt, unless the helper is replaced
+    if (geteuid() != 0 && !Linux_GetCapString(helper).contains("cap_net_admin")) {
+        if (!Linux_HavePkexec() || Linux_Pkexec_SetCapString(helper, HELPER_CAPS) != 0) {
+            qWarning() << "TUN helper: failed to set capabilities on" << helper;
+            return false;
+        }
+    }
+
+    auto runtimeDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+    if (runtimeDir.isEmpty()) runtimeDir = QDir::tempPath();
+    auto socketPath = QStringLiteral("%1/nekobox-tun-%2.sock").arg(runtimeDir).arg(QCoreApplication::applicationPid());
+
+    QByteArray token(32, Qt::Uninitialized);
+    QRandomGenerator::system()->fillRange(reinterpret_cast<quint32 *>(token.data()), token.size() / 4);
+    token = token.toHex();
+
+    m_process = new QProcess(this);
+    m_process->setProcessChannelMode(QProcess::ForwardedErrorChannel);
+    m_process->start(helper, {socketPath});
+    if (!m_process->waitForStarted(3000)) {
+        disconnectHelper();
+        return false;
+    }
+    m_process->write(token + "\n");
+    m_process->closeWriteChannel();
+    // the helper prints "ready" once it listens
+    while (!m_process->canReadLine()) {
+        if (!m_process->waitForReadyRead(3000)) {
+            qWarning() << "TUN helper: not ready";
+            disconnectHelper();
+            return false;
+        }
+    }
+    if (m_process->readLine().trimmed() != "ready") {
+        disconnectHelper();
+        return false;
+    }
+
+    m_socket = new QLocalSocket(this);
+    connect(m_socket, &QLocalSocket::readyRead, this, &TunHelperClient::onReadyRead);
+    m_socket->connectToServer(socketPath);
+    if (!m_socket->waitForConnected(1000) || !Command("auth", token)) {
+        qWarning() << "TUN helper: authentication failed";
+        disconnectHelper();
+        return false;
+    }
+    return true;
+}
+
+bool TunHelperClient::Command(const QString &command, const QString &arg, QString *error) {
+    if (!IsConnected()) {
+        if (error) *error = "not connected";
+        return false;
+    }
+
+    m_reply.clear();
+    auto line = command.toUtf8();
+    if (!arg.isEmpty()) line += " " + arg.toUtf8();
+    m_socket->write(line + "\n");
+    m_socket->flush();
+
+    // log and exit lines arriving meanwhile are dispatched by onReadyRead
+    while (m_reply.isEmpty()) {
+        if (!m_socket->waitForReadyRead(10000)) {
+            if (error) *error = "helper timeout";
+            return false;
+        }
+    }
+    if (m_reply == "ok") return true;
+    if (error) *error = QString::fromUtf8(m_reply.mid(6)); // "error "
+    return false;
+}
+
+void TunHelperClient::onReadyRead() {
+    m_buffer += m_socket->readAll();
+    int end;
+    while ((end = m_buffer.indexOf('\n')) >= 0) {
+        auto line = m_buffer.left(end);
+        m_buffer.remove(0, end + 1);
+        if (line.startsWith("log ")) {
+            emit logOutput(QString::fromUtf8(line.mid(4)));
+        } else if (line.startsWith("exit ")) {
+            emit coreFinished(line.mid(5).toInt());
+        } else {
+            m_reply = line;
+        }
+    }
+}
+
+void TunHelperClient::disconnectHelper() {
+    if (m_socket != nullptr) {
+        m_socket->disconnect(this);
+        m_socket->abort();
+        m_socket->deleteLater();
+        m_socket = nullptr;
+    }
+    if (m_process != nullptr) {
+        // the helper stops its core and exits when the connection closes
+        if (!m_process->waitForFinished(2000)) m_process->kill();
+        m_process->deleteLater();
+        m_process = nullptr;
+    }
+    m_buffer.clear();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <QLocalSocket>
+#include <QProcess>
+
+// Resident privileged helper for TUN mode (nekobox_tun_helper).
+//
+// The helper gets the network capabilities once via setcap, so starting it
+// needs no polkit prompt. It runs the core with those capabilities on
+// request, over a Unix socket only the user can open and guarded by a
+// random token handed over on its stdin.
+//
+// Protocol, one line per message:
+//   client: auth <token> | start <config> | stop | reconfigure <config> | quit
+//   helper: ok | error <message> | log <line> | exit <code>
+class TunHelperClient : public QObject {
+    Q_OBJECT
+
+public:
+    explicit TunHelperClient(QObject *parent = nullptr);
+
+    ~TunHelperClient() override;
+
+    static QString HelperPath();
+
+    // Starts the helper and authenticates, grants its capabilities the first time.
+    bool Connect();
+
+    bool IsConnected() const;
+
+    bool Command(const QString &command, const QString &arg = {}, QString *error = nullptr);
+
+signals:
+    void logOutput(const QString &line);
+
+    void coreFinished(int exitCode);
+
+private:
+    QProcess *m_process = nullptr;
+    QLocalSocket *m_socket = nullptr;
+    QByteArray m_buffer;
+    QByteArray m_reply;
+
+    void onReadyRead();
+
+    void disconnectHelper();
+};
@@ -0,0 +1,221 @@
+// nekobox_tun_helper: resident privileged helper for TUN mode, see sys/linux/TunHelper.hpp
+//
+// It holds cap_net_admin from setcap, raises it into the ambient set and
+// runs the core with it. It serves one authenticated client and exits,
+// stopping the core, when that client goes away.
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QProcess>
+
+#include <cstdio>
+#include <linux/capability.h>
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    const int networkCaps[] = {CAP_NET_ADMIN, CAP_NET_BIND_SERVICE, CAP_NET_RAW};
+
+    // so the core inherits them across exec
+    bool raiseAmbientCaps() {
+        if (geteuid() == 0) return true;
+
+        __user_cap_header_struct header{_LINUX_CAPABILITY_VERSION_3, 0};
+        __user_cap_data_struct data[2]{};
+        if (syscall(SYS_capget, &header, data) != 0) return false;
+        for (auto cap: networkCaps) {
+            auto &d = data[cap / 32];
+            if (d.permitted & (1u << (cap % 32))) d.inheritable |= 1u << (cap % 32);
+        }
+        if (syscall(SYS_capset, &header, data) != 0) return false;
+
+        bool admin = false;
+        for (auto cap: networkCaps) {
+            if (!(data[cap / 32].permitted & (1u << (cap % 32)))) continue;
+            if (prctl(PR_CAP_AMBIENT, PR_CAP_AMBIENT_RAISE, cap, 0, 0) == 0 && cap == CAP_NET_ADMIN) admin = true;
+        }
+        return admin;
+    }
+
+    bool samePeerUser(QLocalSocket *socket) {
+        ucred cred{};
+        socklen_t len = sizeof(cred);
+        if (getsockopt((int) socket->socketDescriptor(), SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) return false;
+        return cred.uid == getuid();
+    }
+
+    bool sameToken(const QByteArray &a, const QByteArray &b) {
+        if (a.size() != b.size()) return false;
+        char diff = 0;
+        for (int i = 0; i < a.size(); i++) diff |= a[i] ^ b[i];
+        return diff == 0;
+    }
+
+    QString findCore() {
+        // next to the helper itself, never from the command line
+        auto dir = QCoreApplication::applicationDirPath();
+        for (const auto &name: {"nekobox_core", "nekoray_core", "sing-box"}) {
+            auto path = dir + "/" + name;
+            if (QFile::exists(path)) return path;
+        }
+        return {};
+    }
+
+    class Helper : public QObject {
+    public:
+        Helper(QByteArray token, QString corePath) : m_token(std::move(token)), m_corePath(std::move(corePath)) {}
+
+        bool Listen(const QString &path) {
+            m_server.setSocketOptions(QLocalServer::UserAccessOption);
+            QLocalServer::removeServer(path);
+            connect(&m_server, &QLocalServer::newConnection, this, &Helper::onNewConnection);
+            return m_server.listen(path);
+        }
+
+    private:
+        QLocalServer m_server;
+        QLocalSocket *m_client = nullptr;
+        bool m_authenticated = false;
+        QByteArray m_token;
+        QString m_corePath;
+        QProcess *m_core = nullptr;
+
+        void send(const QByteArray &line) {
+            if (m_client != nullptr) m_client->write(line + "\n");
+        }
+
+        void onNewConnection() {
+            while (auto socket = m_server.nextPendingConnection()) {
+                if (m_client != nullptr || !samePeerUser(socket)) {
+                    socket->abort();
+                    socket->deleteLater();
+                    continue;
+                }
+                m_client = socket;
+                connect(socket, &QLocalSocket::readyRead, this, &Helper::onReadyRead);
+                connect(socket, &QLocalSocket::disconnected, this, [this] {
+                    stopCore();
+                    QCoreApplication::quit();
+                });
+            }
+        }
+
+        void onReadyRead() {
+            while (m_client != nullptr && m_client->canReadLine()) {
+                auto line = m_client->readLine().trimmed();
+                auto space = line.indexOf(' ');
+                auto command = space < 0 ? line : line.left(space);
+                auto arg = space < 0 ? QByteArray() : line.mid(space + 1);
+
+                if (!m_authenticated) {
+                    if (command != "auth" || !sameToken(arg, m_token)) {
+                        m_client->abort(); // quits through disconnected
+                        return;
+                    }
+                    m_authenticated = true;
+                    send("ok");
+                } else if (command == "start") {
+                    reply(startCore(QString::fromUtf8(arg)));
+                } else if (command == "stop") {
+                    stopCore();
+                    send("ok");
+                } else if (command == "reconfigure") {
+                    stopCore();
+                    reply(startCore(QString::fromUtf8(arg)));
+                } else if (command == "quit") {
+                    stopCore();
+                    send("ok");
+                    m_client->flush();
+                    QCoreApplication::quit();
+                    return;
+                } else {
+                    send("error unknown command");
+                }
+            }
+        }
+
+        void reply(const QString &error) {
+            send(error.isEmpty() ? "ok" : "error " + error.toUtf8());
+        }
+
+        QString startCore(const QString &config) {
+            if (m_core != nullptr) return "already running";
+            if (!QFileInfo(config).isFile()) return "config not found";
+
+            m_core = new QProcess(this);
+            m_core->setProcessChannelMode(QProcess::MergedChannels);
+            connect(m_core, &QProcess::readyRead, this, [this] {
+                while (m_core != nullptr && m_core->canReadLine()) {
+                    send("log " + m_core->readLine().trimmed());
+                }
+            });
+            connect(m_core, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), this, [this](int exitCode) {
+                send("exit " + QByteArray::number(exitCode));
+                m_core->deleteLater();
+                m_core = nullptr;
+            });
+            m_core->start(m_corePath, {"--disable-color", "run", "-c", config});
+            if (!m_core->waitForStarted(3000)) {
+                auto error = m_core->errorString();
+                m_core->disconnect(this);
+                m_core->deleteLater();
+                m_core = nullptr;
+                return error;
+            }
+            return {};
+        }
+
+        void stopCore() {
+            if (m_core == nullptr) return;
+            auto core = m_core;
+            m_core = nullptr; // no exit line for a requested stop
+            core->disconnect(this);
+            core->terminate();
+            if (!core->waitForFinished(5000)) {
+                core->kill();
+                core->waitForFinished(2000);
+            }
+            core->deleteLater();
+        }
+    };
+} // namespace
+
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <socket path>, token on stdin\n", argv[0]);
+        return 1;
+    }
+    if (!raiseAmbientCaps()) {
+        fprintf(stderr, "nekobox_tun_helper: missing cap_net_admin\n");
+        return 1;
+    }
+    auto corePath = findCore();
+    if (corePath.isEmpty()) {
+        fprintf(stderr, "nekobox_tun_helper: core not found\n");
+        return 1;
+    }
+
+    QFile in;
+    if (!in.open(stdin, QIODevice::ReadOnly)) return 1;
+    auto token = in.readLine().trimmed();
+    if (token.size() < 32) {
+        fprintf(stderr, "nekobox_tun_helper: no token\n");
+        return 1;
+    }
+
+    Helper helper(token, corePath);
+    if (!helper.Listen(QString::fromLocal8Bit(argv[1]))) {
+        fprintf(stderr, "nekobox_tun_helper: failed to listen on %s\n", argv[1]);
+        return 1;
+    }
+    printf("ready\n");
+    fflush(stdout);
+
+    return app.exec();
+}
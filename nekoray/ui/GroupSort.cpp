@@ -0,0 +1,101 @@
+#include "GroupSort.hpp"
+
+#include "db/Database.hpp"
+
+#include <algorithm>
+#include <vector>
+
+GroupSorter::Key GroupSorter::extract(int id) const {
+    Key key;
+    auto profile = NekoGui::profileManager->GetProfile(id);
+    if (profile == nullptr) return key;
+    switch (action.method) {
+        case GroupSortMethod::ByType:
+            key.text = profile->meta.type;
+            break;
+        case GroupSortMethod::ByAddress:
+            key.text = profile->meta.address;
+            break;
+        case GroupSortMethod::ByName:
+            key.text = profile->meta.name;
+            break;
+        case GroupSortMethod::ByLatency:
+            key.text = profile->full_test_report;
+            key.latency = profile->latency;
+            if (key.latency == 0) key.latency = 100000;
+            if (key.latency < 0) key.latency = 99999;
+            break;
+        default:
+            break;
+    }
+    return key;
+}
+
+bool GroupSorter::less(const Key &a, const Key &b) const {
+    // compare latency if full_test_report is empty
+    if (action.method == GroupSortMethod::ByLatency && a.text.isEmpty() && b.text.isEmpty()) {
+        return action.descending ? a.latency > b.latency : a.latency < b.latency;
+    }
+    return action.descending ? a.text > b.text : a.text < b.text;
+}
+
+void GroupSorter::Sort(QList<int> &order, const GroupSortAction &action_) {
+    action = action_;
+    active = true;
+    changed.clear();
+    keys.clear();
+    keys.reserve(order.size());
+
+    std::vector<std::pair<Key, int>> flat;
+    flat.reserve(order.size());
+    for (auto id: order) {
+        auto key = extract(id);
+        keys.insert(id, key);
+        flat.emplace_back(std::move(key), id);
+    }
+    std::stable_sort(flat.begin(), flat.end(), [this](const auto &a, const auto &b) {
+        return less(a.first, b.first);
+    });
+
+    for (int i = 0; i < order.size(); i++) {
+        order[i] = flat[i].second;
+    }
+}
+
+void GroupSorter::Clear() {
+    active = false;
+    keys.clear();
+    changed.clear();
+}
+
+void GroupSorter::MarkChanged(int id) {
+    if (active) changed << id;
+}
+
+bool GroupSorter::Update(QList<int> &order) {
+    if (!active || changed.isEmpty()) return false;
+
+    QSet<int> moving;
+    for (auto id: changed) {
+        if (!keys.contains(id)) continue; // not in this group
+        auto key = extract(id);
+        auto &old = keys[id];
+        if (key.text == old.text && key.latency == old.latency) continue;
+        old = key;
+        moving << id;
+    }
+    changed.clear();
+    if (moving.isEmpty()) return false;
+
+    // the rest keeps its relative order, which is still sorted
+    auto before = order;
+    order.erase(std::remove_if(order.begin(), order.end(), [&](int id) { return moving.contains(id); }), order.end());
+    for (auto id: moving) {
+        auto key = keys.value(id);
+        auto it = std::upper_bound(order.begin(), order.end(), id, [&](int, int other) {
+            return less(key, keys.value(other));
+        });
+        order.insert(it, id);
+    }
+    return order != before;
+}
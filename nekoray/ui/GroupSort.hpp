@@ -1,5 +1,10 @@
 #pragma once
 
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+
 // implement in mainwindow
 namespace GroupSortMethod {
     enum GroupSortMethod {
@@ -18,3 +23,36 @@ struct GroupSortAction {
     bool descending = false; // 默认升序，开这个就是降序
     bool scroll_to_started = false;
 };
+
+// Sorts profile ids by keys extracted once per profile, and keeps them so a
+// few changed profiles (after a speed test) can be moved into place alone.
+class GroupSorter {
+public:
+    // Stable sort of order by action, which must be one of the By* key methods
+    void Sort(QList<int> &order, const GroupSortAction &action);
+
+    // Forget the keys, the order is no longer sorted by them
+    void Clear();
+
+    [[nodiscard]] bool Active() const { return active; }
+
+    void MarkChanged(int id);
+
+    // Re-extracts the keys of the changed profiles and moves only those, returns false if nothing moved
+    bool Update(QList<int> &order);
+
+private:
+    struct Key {
+        QString text;
+        int latency = 0;
+    };
+
+    bool active = false;
+    GroupSortAction action;
+    QHash<int, Key> keys;
+    QSet<int> changed;
+
+    [[nodiscard]] Key extract(int id) const;
+
+    [[nodiscard]] bool less(const Key &a, const Key &b) const;
+};
@@ -46,7 +46,8 @@ DialogEditGroup::DialogEditGroup(const std::shared_ptr<NekoGui::Group> &ent, QWi
 
     connect(ui->copy_links, &QPushButton::clicked, this, [=] {
         QStringList links;
-        for (const auto &[_, profile]: NekoGui::profileManager->profiles) {
+        auto table = NekoGui::profileManager->Profiles();
+        for (const auto &[_, profile]: table->profiles) {
             if (profile->gid != ent->id) continue;
             links += profile->bean->ToShareLink();
         }
@@ -55,7 +56,8 @@ DialogEditGroup::DialogEditGroup(const std::shared_ptr<NekoGui::Group> &ent, QWi
     });
     connect(ui->copy_links_nkr, &QPushButton::clicked, this, [=] {
         QStringList links;
-        for (const auto &[_, profile]: NekoGui::profileManager->profiles) {
+        auto table = NekoGui::profileManager->Profiles();
+        for (const auto &[_, profile]: table->profiles) {
             if (profile->gid != ent->id) continue;
             links += profile->bean->ToNekorayShareLink(profile->type);
         }
@@ -120,6 +120,7 @@ DialogEditProfile::DialogEditProfile(const QString &_type, int profileOrGroupId,
         ui->type->addItem(tr("Custom (%1 config)").arg(software_core_name), "internal-full");
         ui->type->addItem(tr("Custom (Extra Core)"), "custom");
         LOAD_TYPE("chain")
+        LOAD_TYPE("balancer")
 
         // type changed
         connect(ui->type, static_cast<void (QComboBox::*)(int)>(&QComboBox::currentIndexChanged), this, [=](int index) {
@@ -155,7 +156,7 @@ void DialogEditProfile::typeSelected(const QString &newType) {
         auto _innerWidget = new EditShadowSocks(this);
         innerWidget = _innerWidget;
         innerEditor = _innerWidget;
-    } else if (type == "chain") {
+    } else if (type == "chain" || type == "balancer") {
         auto _innerWidget = new EditChain(this);
         innerWidget = _innerWidget;
         innerEditor = _innerWidget;
@@ -197,14 +198,14 @@ void DialogEditProfile::typeSelected(const QString &newType) {
     }
 
     // hide some widget
-    auto showAddressPort = type != "chain" && customType != "internal" && customType != "internal-full";
+    auto showAddressPort = type != "chain" && type != "balancer" && customType != "internal" && customType != "internal-full";
     ui->address->setVisible(showAddressPort);
     ui->address_l->setVisible(showAddressPort);
     ui->port->setVisible(showAddressPort);
     ui->port_l->setVisible(showAddressPort);
 
     // 右边 stream
-    auto stream = GetStreamSettings(ent->bean.get());
+    auto stream = GetStreamSettings(ent->bean.Get());
     if (stream != nullptr) {
         ui->right_all_w->setVisible(true);
         ui->network->setCurrentText(stream->network);
@@ -236,7 +237,7 @@ void DialogEditProfile::typeSelected(const QString &newType) {
     CACHE.custom_outbound = ent->bean->custom_outbound;
     bool show_custom_config = true;
     bool show_custom_outbound = true;
-    if (type == "chain") {
+    if (type == "chain" || type == "balancer") {
         show_custom_outbound = false;
     } else if (type == "custom") {
         if (customType == "internal") {
@@ -340,7 +341,7 @@ bool DialogEditProfile::onEnd() {
     ent->bean->serverPort = ui->port->text().toInt();
 
     // 右边 stream
-    auto stream = GetStreamSettings(ent->bean.get());
+    auto stream = GetStreamSettings(ent->bean.Get());
     if (stream != nullptr) {
         stream->network = ui->network->currentText();
         stream->security = ui->security->currentText();
@@ -477,11 +478,11 @@ void DialogEditProfile::on_apply_to_group_clicked() {
 }
 
 void DialogEditProfile::do_apply_to_group(const std::shared_ptr<NekoGui::Group> &group, QWidget *key) {
-    auto stream = GetStreamSettings(ent->bean.get());
+    auto stream = GetStreamSettings(ent->bean.Get());
 
     auto copyStream = [=](void *p) {
         for (const auto &profile: group->Profiles()) {
-            auto newStream = GetStreamSettings(profile->bean.get());
+            auto newStream = GetStreamSettings(profile->bean.Get());
             if (newStream == nullptr) continue;
             if (stream == newStream) continue;
             newStream->_setValue(stream->_name(p), p);
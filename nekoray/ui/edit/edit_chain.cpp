@@ -6,6 +6,7 @@
 
 #include "db/Database.hpp"
 #include "fmt/ChainBean.hpp"
+#include "fmt/BalancerBean.hpp"
 
 EditChain::EditChain(QWidget *parent) : QWidget(parent), ui(new Ui::EditChain) {
     ui->setupUi(this);
@@ -22,6 +23,17 @@ void EditChain::onStart(std::shared_ptr<NekoGui::ProxyEntity> _ent) {
     for (auto id: bean->list) {
         AddProfileToListIfExist(id);
     }
+
+    if (ent->type == "balancer") {
+        auto bean = this->ent->BalancerBean();
+        ui->label->setText(tr("Members, leave empty to use the whole group"));
+        ui->listWidget->setDragDropMode(QAbstractItemView::NoDragDrop);
+        P_LOAD_STRING(url)
+        P_LOAD_INT(interval)
+        P_LOAD_INT(tolerance)
+    } else {
+        ui->balancer_box->hide();
+    }
 }
 
 bool EditChain::onEnd() {
@@ -38,6 +50,13 @@ bool EditChain::onEnd() {
     }
     bean->list = idList;
 
+    if (ent->type == "balancer") {
+        auto bean = this->ent->BalancerBean();
+        P_SAVE_STRING(url)
+        P_SAVE_INT(interval)
+        P_SAVE_INT(tolerance)
+    }
+
     return true;
 }
 
@@ -51,7 +70,7 @@ void EditChain::on_select_profile_clicked() {
 
 void EditChain::AddProfileToListIfExist(int profileId) {
     auto _ent = NekoGui::profileManager->GetProfile(profileId);
-    if (_ent != nullptr && _ent->type != "chain") {
+    if (_ent != nullptr && _ent->type != "balancer" && (_ent->type != "chain" || ent->type == "balancer")) {
         auto wI = new QListWidgetItem();
         wI->setData(114514, profileId);
         auto w = new ProxyItem(this, _ent, wI);
@@ -70,7 +89,7 @@ void EditChain::AddProfileToListIfExist(int profileId) {
 
 void EditChain::ReplaceProfile(ProxyItem *w, int profileId) {
     auto _ent = NekoGui::profileManager->GetProfile(profileId);
-    if (_ent != nullptr && _ent->type != "chain") {
+    if (_ent != nullptr && _ent->type != "balancer" && (_ent->type != "chain" || ent->type == "balancer")) {
         w->item->setData(114514, profileId);
         w->ent = _ent;
         w->refresh_data();
@@ -7,6 +7,7 @@
 #include "sub/GroupUpdater.hpp"
 #include "sys/ExternalProcess.hpp"
 #include "sys/AutoRun.hpp"
+#include "sys/Executor.hpp"
 
 #include "ui/ThemeManager.hpp"
 #include "ui/Icon.hpp"
@@ -102,7 +103,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
     ui->menubar->setVisible(false);
     connect(ui->toolButton_document, &QToolButton::clicked, this, [=] { QDesktopServices::openUrl(QUrl("https://matsuridayo.github.io/")); });
     connect(ui->toolButton_ads, &QToolButton::clicked, this, [=] { QDesktopServices::openUrl(QUrl("https://neko-box.pages.dev/喵")); });
-    connect(ui->toolButton_update, &QToolButton::clicked, this, [=] { runOnNewThread([=] { CheckUpdate(); }); });
+    connect(ui->toolButton_update, &QToolButton::clicked, this, [=] { NekoGui_sys::executor->Submit([=] { CheckUpdate(); }, NekoGui_sys::TaskClass::IO); });
     connect(ui->toolButton_url_test, &QToolButton::clicked, this, [=] { speedtest_current_group(1, true); });
 
     // Setup log UI
@@ -145,7 +146,7 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         group->order = ui->proxyListTable->order;
         group->Save();
     };
-    ui->proxyListTable->refresh_data = [=](int id) { refresh_proxy_list_impl_refresh_data(id); };
+    ui->proxyListTable->proxyModel->SetHeaders({tr("Type"), tr("Address"), tr("Name"), tr("Test Result"), tr("Traffic")});
     if (auto button = ui->proxyListTable->findChild<QAbstractButton *>(QString(), Qt::FindDirectChildrenOnly)) {
         // Corner Button
         connect(button, &QAbstractButton::clicked, this, [=] { refresh_proxy_list_impl(-1, {GroupSortMethod::ById}); });
@@ -209,18 +210,13 @@ MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWi
         }
     });
     connect(ui->search, &QLineEdit::textChanged, this, [=](const QString &text) {
-        if (text.isEmpty()) {
-            for (int i = 0; i < ui->proxyListTable->rowCount(); i++) {
-                ui->proxyListTable->setRowHidden(i, false);
-            }
-        } else {
-            QList<QTableWidgetItem *> findItem = ui->proxyListTable->findItems(text, Qt::MatchContains);
-            for (int i = 0; i < ui->proxyListTable->rowCount(); i++) {
-                ui->proxyListTable->setRowHidden(i, true);
-            }
-            for (auto item: findItem) {
-                if (item != nullptr) ui->proxyListTable->setRowHidden(item->row(), false);
-            }
+        QSet<int> found;
+        if (!text.isEmpty()) {
+            for (auto id: NekoGui::profileManager->SearchProfiles(text)) found << id;
+        }
+        auto model = ui->proxyListTable->proxyModel;
+        for (int i = 0; i < model->rowCount(); i++) {
+            ui->proxyListTable->setRowHidden(i, !text.isEmpty() && !found.contains(model->IdAt(i)));
         }
     });
 
@@ -553,7 +549,7 @@ void MainWindow::dialog_message_impl(const QString &sender, const QString &info)
     } else if (info == "Raise") {
         ActivateWindow(this);
     } else if (info == "ClearConnectionList") {
-        refresh_connection_list({});
+        refresh_connection_list({true});
     }
     // sender
     if (sender == Dialog_DialogEditProfile) {
@@ -665,13 +661,13 @@ void MainWindow::on_menu_exit_triggered() {
         neko_stop(false, true);
         //
         hide();
-        runOnNewThread([=] {
+        NekoGui_sys::executor->Submit([=] {
             sem_stopped.acquire();
             stop_core_daemon();
             runOnUiThread([=] {
                 on_menu_exit_triggered(); // continue exit progress
             });
-        });
+        }, NekoGui_sys::TaskClass::IO, NekoGui_sys::TaskPriority::High);
         return;
     }
     //
@@ -939,15 +935,11 @@ void MainWindow::refresh_proxy_list(const int &id) {
 void MainWindow::refresh_proxy_list_impl(const int &id, GroupSortAction groupSortAction) {
     // id < 0 重绘
     if (id < 0) {
-        // 清空数据
+        // 清空数据, 行由 update_order 交给 model
         ui->proxyListTable->row2Id.clear();
-        ui->proxyListTable->setRowCount(0);
-        // 添加行
-        int row = -1;
-        for (const auto &[id, profile]: NekoGui::profileManager->profiles) {
+        auto table = NekoGui::profileManager->Profiles();
+        for (const auto &[id, profile]: table->profiles) {
             if (NekoGui::dataStore->current_group != profile->gid) continue;
-            row++;
-            ui->proxyListTable->insertRow(row);
             ui->proxyListTable->row2Id += id;
         }
     }
@@ -959,61 +951,22 @@ void MainWindow::refresh_proxy_list_impl(const int &id, GroupSortAction groupSor
                 auto group = NekoGui::profileManager->CurrentGroup();
                 if (group == nullptr) return;
                 ui->proxyListTable->order = group->order;
+                proxy_sorter.Clear();
                 break;
             }
             case GroupSortMethod::ById: {
                 // Clear Order
                 ui->proxyListTable->order.clear();
                 ui->proxyListTable->callback_save_order();
+                proxy_sorter.Clear();
                 break;
             }
             case GroupSortMethod::ByAddress:
             case GroupSortMethod::ByName:
             case GroupSortMethod::ByLatency:
             case GroupSortMethod::ByType: {
-                std::sort(ui->proxyListTable->order.begin(), ui->proxyListTable->order.end(),
-                          [=](int a, int b) {
-                              QString ms_a;
-                              QString ms_b;
-                              if (groupSortAction.method == GroupSortMethod::ByType) {
-                                  ms_a = NekoGui::profileManager->GetProfile(a)->bean->DisplayType();
-                                  ms_b = NekoGui::profileManager->GetProfile(b)->bean->DisplayType();
-                              } else if (groupSortAction.method == GroupSortMethod::ByName) {
-                                  ms_a = NekoGui::profileManager->GetProfile(a)->bean->name;
-                                  ms_b = NekoGui::profileManager->GetProfile(b)->bean->name;
-                              } else if (groupSortAction.method == GroupSortMethod::ByAddress) {
-                                  ms_a = NekoGui::profileManager->GetProfile(a)->bean->DisplayAddress();
-                                  ms_b = NekoGui::profileManager->GetProfile(b)->bean->DisplayAddress();
-                              } else if (groupSortAction.method == GroupSortMethod::ByLatency) {
-                                  ms_a = NekoGui::profileManager->GetProfile(a)->full_test_report;
-                                  ms_b = NekoGui::profileManager->GetProfile(b)->full_test_report;
-                              }
-                              auto get_latency_for_sort = [](int id) {
-                                  auto i = NekoGui::profileManager->GetProfile(id)->latency;
-                                  if (i == 0) i = 100000;
-                                  if (i < 0) i = 99999;
-                                  return i;
-                              };
-                              if (groupSortAction.descending) {
-                                  if (groupSortAction.method == GroupSortMethod::ByLatency) {
-                                      if (ms_a.isEmpty() && ms_b.isEmpty()) {
-                                          // compare latency if full_test_report is empty
-                                          return get_latency_for_sort(a) > get_latency_for_sort(b);
-                                      }
-                                  }
-                                  return ms_a > ms_b;
-                              } else {
-                                  if (groupSortAction.method == GroupSortMethod::ByLatency) {
-                                      auto int_a = NekoGui::profileManager->GetProfile(a)->latency;
-                                      auto int_b = NekoGui::profileManager->GetProfile(b)->latency;
-                                      if (ms_a.isEmpty() && ms_b.isEmpty()) {
-                                          // compare latency if full_test_report is empty
-                                          return get_latency_for_sort(a) < get_latency_for_sort(b);
-                                      }
-                                  }
-                                  return ms_a < ms_b;
-                              }
-                          });
+                if (ui->proxyListTable->order.isEmpty()) ui->proxyListTable->order = ui->proxyListTable->row2Id;
+                proxy_sorter.Sort(ui->proxyListTable->order, groupSortAction);
                 break;
             }
         }
@@ -1021,66 +974,24 @@ void MainWindow::refresh_proxy_list_impl(const int &id, GroupSortAction groupSor
     }
 
     // refresh data
+    if (id >= 0) proxy_sorter.MarkChanged(id);
     refresh_proxy_list_impl_refresh_data(id);
 }
 
-void MainWindow::refresh_proxy_list_impl_refresh_data(const int &id) {
-    // 绘制或更新item(s)
-    for (int row = 0; row < ui->proxyListTable->rowCount(); row++) {
-        auto profileId = ui->proxyListTable->row2Id[row];
-        if (id >= 0 && profileId != id) continue; // refresh ONE item
-        auto profile = NekoGui::profileManager->GetProfile(profileId);
-        if (profile == nullptr) continue;
-
-        auto isRunning = profileId == NekoGui::dataStore->started_id;
-        auto f0 = std::make_unique<QTableWidgetItem>();
-        f0->setData(114514, profileId);
-
-        // Check state
-        auto check = f0->clone();
-        check->setText(isRunning ? "✓" : Int2String(row + 1));
-        ui->proxyListTable->setVerticalHeaderItem(row, check);
-
-        // C0: Type
-        auto f = f0->clone();
-        f->setText(profile->bean->DisplayType());
-        if (isRunning) f->setForeground(palette().link());
-        ui->proxyListTable->setItem(row, 0, f);
-
-        // C1: Address+Port
-        f = f0->clone();
-        f->setText(profile->bean->DisplayAddress());
-        if (isRunning) f->setForeground(palette().link());
-        ui->proxyListTable->setItem(row, 1, f);
-
-        // C2: Name
-        f = f0->clone();
-        f->setText(profile->bean->name);
-        if (isRunning) f->setForeground(palette().link());
-        ui->proxyListTable->setItem(row, 2, f);
-
-        // C3: Test Result
-        f = f0->clone();
-        if (profile->full_test_report.isEmpty()) {
-            auto color = profile->DisplayLatencyColor();
-            if (color.isValid()) f->setForeground(color);
-            f->setText(profile->DisplayLatency());
-        } else {
-            f->setText(profile->full_test_report);
-        }
-        ui->proxyListTable->setItem(row, 3, f);
+void MainWindow::resort_proxy_list() {
+    if (!proxy_sorter.Update(ui->proxyListTable->order)) return;
+    ui->proxyListTable->update_order(true);
+}
 
-        // C4: Traffic
-        f = f0->clone();
-        f->setText(profile->traffic_data->DisplayTraffic());
-        ui->proxyListTable->setItem(row, 4, f);
-    }
+void MainWindow::refresh_proxy_list_impl_refresh_data(const int &id) {
+    // 只通知变化的行, 可见的行由 view 按需重绘
+    ui->proxyListTable->proxyModel->Refresh(id);
 }
 
 // table菜单相关
 
-void MainWindow::on_proxyListTable_itemDoubleClicked(QTableWidgetItem *item) {
-    auto id = item->data(114514).toInt();
+void MainWindow::on_proxyListTable_doubleClicked(const QModelIndex &index) {
+    auto id = index.data(ProxyListModel::ProfileIdRole).toInt();
     if (select_mode) {
         emit profile_selected(id);
         select_mode = false;
@@ -1145,9 +1056,9 @@ void MainWindow::on_menu_delete_triggered() {
     if (ents.count() == 0) return;
     if (QMessageBox::question(this, tr("Confirmation"), QString(tr("Remove %1 item(s) ?")).arg(ents.count())) ==
         QMessageBox::StandardButton::Yes) {
-        for (const auto &ent: ents) {
-            NekoGui::profileManager->DeleteProfile(ent->id);
-        }
+        QList<int> ids;
+        for (const auto &ent: ents) ids << ent->id;
+        NekoGui::profileManager->DeleteProfiles(ids);
         refresh_proxy_list();
     }
 }
@@ -1378,9 +1289,9 @@ void MainWindow::on_menu_delete_repeat_triggered() {
 
     if (out_del.length() > 0 &&
         QMessageBox::question(this, tr("Confirmation"), tr("Remove %1 item(s) ?").arg(out_del.length()) + "\n" + remove_display) == QMessageBox::StandardButton::Yes) {
-        for (const auto &ent: out_del) {
-            NekoGui::profileManager->DeleteProfile(ent->id);
-        }
+        QList<int> ids;
+        for (const auto &ent: out_del) ids << ent->id;
+        NekoGui::profileManager->DeleteProfiles(ids);
         refresh_proxy_list();
     }
 }
@@ -1398,7 +1309,8 @@ void MainWindow::on_menu_update_subscription_triggered() {
 void MainWindow::on_menu_remove_unavailable_triggered() {
     QList<std::shared_ptr<NekoGui::ProxyEntity>> out_del;
 
-    for (const auto &[_, profile]: NekoGui::profileManager->profiles) {
+    auto table = NekoGui::profileManager->Profiles();
+    for (const auto &[_, profile]: table->profiles) {
         if (NekoGui::dataStore->current_group != profile->gid) continue;
         if (profile->latency < 0) out_del += profile;
     }
@@ -1415,9 +1327,9 @@ void MainWindow::on_menu_remove_unavailable_triggered() {
 
     if (out_del.length() > 0 &&
         QMessageBox::question(this, tr("Confirmation"), tr("Remove %1 item(s) ?").arg(out_del.length()) + "\n" + remove_display) == QMessageBox::StandardButton::Yes) {
-        for (const auto &ent: out_del) {
-            NekoGui::profileManager->DeleteProfile(ent->id);
-        }
+        QList<int> ids;
+        for (const auto &ent: out_del) ids << ent->id;
+        NekoGui::profileManager->DeleteProfiles(ids);
         refresh_proxy_list();
     }
 }
@@ -1450,10 +1362,10 @@ void MainWindow::on_proxyListTable_customContextMenuRequested(const QPoint &pos)
 }
 
 QList<std::shared_ptr<NekoGui::ProxyEntity>> MainWindow::get_now_selected_list() {
-    auto items = ui->proxyListTable->selectedItems();
+    auto indexes = ui->proxyListTable->selectionModel()->selectedRows();
     QList<std::shared_ptr<NekoGui::ProxyEntity>> list;
-    for (auto item: items) {
-        auto id = item->data(114514).toInt();
+    for (const auto &index: indexes) {
+        auto id = index.data(ProxyListModel::ProfileIdRole).toInt();
         auto ent = NekoGui::profileManager->GetProfile(id);
         if (ent != nullptr && !list.contains(ent)) list += ent;
     }
@@ -1534,7 +1446,8 @@ void MainWindow::show_log_impl(const QString &log) {
 
 #define ADD_TO_CURRENT_ROUTE(a, b)                                                                   \
     NekoGui::dataStore->routing->a = (SplitLines(NekoGui::dataStore->routing->a) << (b)).join("\n"); \
-    NekoGui::dataStore->routing->Save();
+    NekoGui::dataStore->routing->Save();                                                             \
+    NekoGui::dataStore->Publish();
 
 void MainWindow::on_masterLogBrowser_customContextMenuRequested(const QPoint &pos) {
     QMenu *menu = ui->masterLogBrowser->createStandardContextMenu();
@@ -1645,63 +1558,52 @@ void MainWindow::start_select_mode(QObject *context, const std::function<void(in
 
 // 连接列表
 
-inline QJsonArray last_arr; // format is nekoray_connections_json
+inline QHash<QString, QTableWidgetItem *> conn_rows; // connection id -> outbound cell of its row
 
-void MainWindow::refresh_connection_list(const QJsonArray &arr) {
-    if (last_arr == arr) {
-        return;
+void MainWindow::refresh_connection_list(const NekoGui_traffic::ConnectionDiff &diff) {
+    if (diff.full) {
+        ui->tableWidget_conn->setRowCount(0);
+        conn_rows.clear();
     }
-    last_arr = arr;
 
-    if (NekoGui::dataStore->flag_debug) qDebug() << arr;
+    for (const auto &id: diff.closed) {
+        auto cell = conn_rows.take(id);
+        if (cell != nullptr) ui->tableWidget_conn->removeRow(cell->row());
+    }
 
-    ui->tableWidget_conn->setRowCount(0);
+    for (const auto &conn: diff.updated) {
+        if (NekoGui::dataStore->ignoreConnTag.contains(conn.outbound)) continue;
 
-    int row = -1;
-    for (const auto &_item: arr) {
-        auto item = _item.toObject();
-        if (NekoGui::dataStore->ignoreConnTag.contains(item["Tag"].toString())) continue;
+        auto cell = conn_rows.value(conn.id);
+        int row;
+        if (cell == nullptr) {
+            row = ui->tableWidget_conn->rowCount();
+            ui->tableWidget_conn->insertRow(row);
 
-        row++;
-        ui->tableWidget_conn->insertRow(row);
+            // C0: Status
+            auto c0 = new QLabel;
+            c0->setPixmap(Icon::GetMaterialIcon(conn.outbound == "block" ? "cancel" : "swap-vertical"));
+            c0->setAlignment(Qt::AlignCenter);
+            ui->tableWidget_conn->setCellWidget(row, 0, c0);
 
-        auto f0 = std::make_unique<QTableWidgetItem>();
-        f0->setData(114514, item["ID"].toInt());
+            // C1: Outbound
+            cell = new QTableWidgetItem(conn.outbound);
+            ui->tableWidget_conn->setItem(row, 1, cell);
+            conn_rows[conn.id] = cell;
 
-        // C0: Status
-        auto c0 = new QLabel;
-        auto start_t = item["Start"].toInt();
-        auto end_t = item["End"].toInt();
-        // icon
-        auto outboundTag = item["Tag"].toString();
-        if (outboundTag == "block") {
-            c0->setPixmap(Icon::GetMaterialIcon("cancel"));
+            // C2: Destination
+            auto target = conn.domain.isEmpty() ? conn.destination : conn.domain;
+            auto f = new QTableWidgetItem("[" + conn.network + "] " + target);
+            f->setToolTip(conn.destination + (conn.rule.isEmpty() ? "" : "\n" + conn.rule));
+            ui->tableWidget_conn->setItem(row, 2, f);
         } else {
-            if (end_t > 0) {
-                c0->setPixmap(Icon::GetMaterialIcon("history"));
-            } else {
-                c0->setPixmap(Icon::GetMaterialIcon("swap-vertical"));
-            }
-        }
-        c0->setAlignment(Qt::AlignCenter);
-        c0->setToolTip(tr("Start: %1\nEnd: %2").arg(DisplayTime(start_t), end_t > 0 ? DisplayTime(end_t) : ""));
-        ui->tableWidget_conn->setCellWidget(row, 0, c0);
-
-        // C1: Outbound
-        auto f = f0->clone();
-        f->setToolTip("");
-        f->setText(outboundTag);
-        ui->tableWidget_conn->setItem(row, 1, f);
-
-        // C2: Destination
-        f = f0->clone();
-        QString target1 = item["Dest"].toString();
-        QString target2 = item["RDest"].toString();
-        if (target2.isEmpty() || target1 == target2) {
-            target2 = "";
+            row = cell->row();
         }
-        f->setText("[" + target1 + "] " + target2);
-        ui->tableWidget_conn->setItem(row, 2, f);
+
+        // traffic changes on every update
+        auto c0 = ui->tableWidget_conn->cellWidget(row, 0);
+        c0->setToolTip(tr("Start: %1\nUpload: %2\nDownload: %3")
+                           .arg(DisplayTime(conn.created_at), ReadableSize(conn.upload), ReadableSize(conn.download)));
     }
 }
 
@@ -1779,14 +1681,14 @@ bool MainWindow::StartVPNProcess() {
     auto scriptPath = NekoGui::WriteVPNLinuxScript(configPath);
     //
 #ifdef Q_OS_WIN
-    runOnNewThread([=] {
+    NekoGui_sys::executor->Submit([=] {
         vpn_pid = 1; // TODO get pid?
         WinCommander::runProcessElevated(QApplication::applicationDirPath() + "/nekobox_core.exe",
                                          {"--disable-color", "run", "-c", configPath}, "",
                                          NekoGui::dataStore->vpn_hide_console ? WinCommander::SW_HIDE : WinCommander::SW_SHOWMINIMIZED); // blocking
         vpn_pid = 0;
         runOnUiThread([=] { neko_set_spmode_vpn(false); });
-    });
+    }, NekoGui_sys::TaskClass::LongRunning);
 #else
     //
     auto vpn_process = new QProcess;
@@ -19,6 +19,7 @@
 #include "GroupSort.hpp"
 
 #include "db/ProxyEntity.hpp"
+#include "db/traffic/TrafficLooper.hpp"
 #include "main/GuiUtils.hpp"
 
 #endif
@@ -61,7 +62,7 @@ public:
 
     void start_select_mode(QObject *context, const std::function<void(int)> &callback);
 
-    void refresh_connection_list(const QJsonArray &arr);
+    void refresh_connection_list(const NekoGui_traffic::ConnectionDiff &diff);
 
     void RegisterHotkey(bool unregister);
 
@@ -129,7 +130,7 @@ private slots:
 
     void on_menu_resolve_domain_triggered();
 
-    void on_proxyListTable_itemDoubleClicked(QTableWidgetItem *item);
+    void on_proxyListTable_doubleClicked(const QModelIndex &index);
 
     void on_proxyListTable_customContextMenuRequested(const QPoint &pos);
 
@@ -150,10 +151,12 @@ private:
     QString title_error;
     int icon_status = -1;
     std::shared_ptr<NekoGui::ProxyEntity> running;
+    QMap<int, QString> running_selector; // profile id -> outbound tag behind the running "proxy" selector
     QString traffic_update_cache;
     QTime last_test_time;
     //
     int proxy_last_order = -1;
+    GroupSorter proxy_sorter;
     bool select_mode = false;
     QMutex mu_starting;
     QMutex mu_stopping;
@@ -171,6 +174,8 @@ private:
 
     void refresh_proxy_list_impl_refresh_data(const int &id = -1);
 
+    void resort_proxy_list();
+
     void keyPressEvent(QKeyEvent *event) override;
 
     void closeEvent(QCloseEvent *event) override;
@@ -187,6 +192,8 @@ private:
 
     void speedtest_current_group(int mode, bool test_group);
 
+    void speedtest_profile(const std::shared_ptr<NekoGui::ProxyEntity> &profile, int mode, const QStringList &full_test_flags);
+
     void speedtest_current();
 
     static void stop_core_daemon();
@@ -4,8 +4,10 @@
 #include "db/Database.hpp"
 #include "db/ConfigBuilder.hpp"
 #include "db/traffic/TrafficLooper.hpp"
+#include "db/traffic/TrafficHistory.hpp"
 #include "rpc/gRPC.h"
 #include "ui/widget/MessageBoxTimer.h"
+#include "sys/Executor.hpp"
 
 #include <QTimer>
 #include <QThread>
@@ -26,6 +28,8 @@ std::list<std::shared_ptr<NekoGui_sys::ExternalProcess>> CreateExtCFromExtR(cons
         extC->program = extR->program;
         extC->arguments = extR->arguments;
         extC->env = extR->env;
+        extC->ready_port = extR->ready_port;
+        extC->port_leases = extR->port_leases;
         l.emplace_back(extC);
         //
         if (start) extC->Start();
@@ -49,16 +53,22 @@ void MainWindow::setup_grpc() {
         "127.0.0.1:" + Int2String(NekoGui::dataStore->core_port), NekoGui::dataStore->core_token);
 
     // Looper
-    runOnNewThread([=] { NekoGui_traffic::trafficLooper->Loop(); });
+    NekoGui_sys::executor->Submit([=] { NekoGui_traffic::trafficLooper->Loop(); }, NekoGui_sys::TaskClass::LongRunning);
 #endif
 }
 
 // 测速
 
-inline bool speedtesting = false;
-inline QList<QThread *> speedtesting_threads = {};
+inline std::atomic<bool> speedtesting{false};
+inline NekoGui_sys::CancelToken speedtesting_token;
 
 void MainWindow::speedtest_current_group(int mode, bool test_group) {
+    // menu_stop_testing
+    if (mode == 114514) {
+        speedtesting_token.Cancel();
+        return;
+    }
+
     if (speedtesting) {
         MessageBoxWarning(software_name, QObject::tr("The last speed test did not exit completely, please wait. If it persists, please restart the program."));
         return;
@@ -70,16 +80,6 @@ void MainWindow::speedtest_current_group(int mode, bool test_group) {
     auto group = NekoGui::profileManager->CurrentGroup();
     if (group->archive) return;
 
-    // menu_stop_testing
-    if (mode == 114514) {
-        while (!speedtesting_threads.isEmpty()) {
-            auto t = speedtesting_threads.takeFirst();
-            if (t != nullptr) t->exit();
-        }
-        speedtesting = false;
-        return;
-    }
-
 #ifndef NKR_NO_GRPC
     QStringList full_test_flags;
     if (mode == libcore::FullTest) {
@@ -117,129 +117,137 @@ void MainWindow::speedtest_current_group(int mode, bool test_group) {
         if (full_test_flags.isEmpty()) return;
     }
     speedtesting = true;
+    speedtesting_token = {};
+    auto token = speedtesting_token;
+    auto remaining = std::make_shared<std::atomic<int>>(profiles.size());
+    NekoGui_sys::executor->SetLimit(NekoGui_sys::TaskClass::Test, NekoGui::dataStore->test_concurrent);
+
+    // the last test to finish, or to be cancelled, ends the run
+    auto done = [this, remaining] {
+        if (--*remaining != 0) return;
+        speedtesting = false;
+        MW_show_log(QObject::tr("Speedtest finished."));
+        runOnUiThread([this] { resort_proxy_list(); });
+    };
 
-    runOnNewThread([this, profiles, mode, full_test_flags]() {
-        QMutex lock_write;
-        QMutex lock_return;
-        int threadN = NekoGui::dataStore->test_concurrent;
-        int threadN_finished = 0;
-        auto profiles_test = profiles; // copy
-
-        // Threads
-        lock_return.lock();
-        for (int i = 0; i < threadN; i++) {
-            runOnNewThread([&] {
-                speedtesting_threads << QObject::thread();
-
-                forever {
-                    //
-                    lock_write.lock();
-                    if (profiles_test.isEmpty()) {
-                        threadN_finished++;
-                        if (threadN == threadN_finished) {
-                            // quit control thread
-                            lock_return.unlock();
-                        }
-                        lock_write.unlock();
-                        // quit of this thread
-                        speedtesting_threads.removeAll(QObject::thread());
-                        return;
-                    }
-                    auto profile = profiles_test.takeFirst();
-                    lock_write.unlock();
-
-                    //
-                    libcore::TestReq req;
-                    req.set_mode((libcore::TestMode) mode);
-                    req.set_timeout(10 * 1000);
-                    req.set_url(NekoGui::dataStore->test_latency_url.toStdString());
-
-                    //
-                    std::list<std::shared_ptr<NekoGui_sys::ExternalProcess>> extCs;
-                    QSemaphore extSem;
-
-                    if (mode == libcore::TestMode::UrlTest || mode == libcore::FullTest) {
-                        auto c = BuildConfig(profile, true, false);
-                        if (!c->error.isEmpty()) {
-                            profile->full_test_report = c->error;
-                            profile->Save();
-                            auto profileId = profile->id;
-                            runOnUiThread([this, profileId] {
-                                refresh_proxy_list(profileId);
-                            });
-                            continue;
-                        }
-                        //
-                        if (!c->extRs.empty()) {
-                            runOnUiThread(
-                                [&] {
-                                    extCs = CreateExtCFromExtR(c->extRs, true);
-                                    QThread::msleep(500);
-                                    extSem.release();
-                                },
-                                DS_cores);
-                            extSem.acquire();
-                        }
-                        //
-                        auto config = new libcore::LoadConfigReq;
-                        config->set_core_config(QJsonObject2QString(c->coreConfig, false).toStdString());
-                        req.set_allocated_config(config);
-                        req.set_in_address(profile->bean->serverAddress.toStdString());
-
-                        req.set_full_latency(full_test_flags.contains("1"));
-                        req.set_full_udp_latency(full_test_flags.contains("2"));
-                        req.set_full_speed(full_test_flags.contains("3"));
-                        req.set_full_in_out(full_test_flags.contains("4"));
-
-                        req.set_full_speed_url(NekoGui::dataStore->test_download_url.toStdString());
-                        req.set_full_speed_timeout(NekoGui::dataStore->test_download_timeout);
-                    } else if (mode == libcore::TcpPing) {
-                        req.set_address(profile->bean->DisplayAddress().toStdString());
-                    }
-
-                    bool rpcOK;
-                    auto result = defaultClient->Test(&rpcOK, req);
-                    //
-                    if (!extCs.empty()) {
-                        runOnUiThread(
-                            [&] {
-                                for (const auto &extC: extCs) {
-                                    extC->Kill();
-                                }
-                                extSem.release();
-                            },
-                            DS_cores);
-                        extSem.acquire();
-                    }
-                    //
-                    if (!rpcOK) return;
+    for (const auto &profile: profiles) {
+        NekoGui_sys::executor->Submit([=] {
+            if (!token.IsCancelled()) speedtest_profile(profile, mode, full_test_flags);
+            done();
+        }, NekoGui_sys::TaskClass::Test);
+    }
+#endif
+}
 
-                    if (result.error().empty()) {
-                        profile->latency = result.ms();
-                        if (profile->latency == 0) profile->latency = 1; // nekoray use 0 to represents not tested
-                    } else {
-                        profile->latency = -1;
+void MainWindow::speedtest_profile(const std::shared_ptr<NekoGui::ProxyEntity> &profile, int mode, const QStringList &full_test_flags) {
+#ifndef NKR_NO_GRPC
+    auto ds = NekoGui::dataStore->Snapshot();
+    libcore::TestReq req;
+    req.set_mode((libcore::TestMode) mode);
+    req.set_timeout(10 * 1000);
+    req.set_url(ds->test_latency_url.toStdString());
+
+    //
+    std::list<std::shared_ptr<NekoGui_sys::ExternalProcess>> extCs;
+    QSemaphore extSem;
+
+    if (mode == libcore::TestMode::UrlTest || mode == libcore::FullTest) {
+        std::shared_ptr<NekoGui::BuildConfigResult> c;
+        // an external core that exits before it listens may have found a leased port
+        // taken, the pool skips it from then on, so the second build gets another one
+        for (int attempt = 0; attempt < 2; attempt++) {
+            c = BuildConfig(profile, true, false);
+            if (!c->error.isEmpty()) {
+                profile->full_test_report = c->error;
+                profile->Save();
+                auto profileId = profile->id;
+                runOnUiThread([this, profileId] {
+                    refresh_proxy_list(profileId);
+                });
+                return;
+            }
+            //
+            if (c->extRs.empty()) break;
+            runOnUiThread(
+                [&] {
+                    extCs = CreateExtCFromExtR(c->extRs, true);
+                    extSem.release();
+                },
+                DS_cores);
+            extSem.acquire();
+            bool exited = false;
+            for (const auto &extC: extCs) {
+                if (!extC->WaitForReady(3000)) {
+                    exited = extC->Exited();
+                    if (!exited || attempt > 0) {
+                        MW_show_log(tr("[%1] external core is not ready, testing anyway").arg(profile->bean->DisplayTypeAndName()));
                     }
-                    profile->full_test_report = result.full_report().c_str(); // higher priority
-                    profile->Save();
-
-                    if (!result.error().empty()) {
-                        MW_show_log(tr("[%1] test error: %2").arg(profile->bean->DisplayTypeAndName(), result.error().c_str()));
+                    break;
+                }
+            }
+            if (!exited || attempt > 0) break;
+            runOnUiThread(
+                [&] {
+                    for (const auto &extC: extCs) {
+                        extC->Kill();
                     }
+                    extCs.clear();
+                    extSem.release();
+                },
+                DS_cores);
+            extSem.acquire();
+        }
+        //
+        auto config = new libcore::LoadConfigReq;
+        config->set_core_config(QJsonObject2QString(c->coreConfig, false).toStdString());
+        req.set_allocated_config(config);
+        req.set_in_address(profile->bean->serverAddress.toStdString());
+
+        req.set_full_latency(full_test_flags.contains("1"));
+        req.set_full_udp_latency(full_test_flags.contains("2"));
+        req.set_full_speed(full_test_flags.contains("3"));
+        req.set_full_in_out(full_test_flags.contains("4"));
+
+        req.set_full_speed_url(ds->test_download_url.toStdString());
+        req.set_full_speed_timeout(ds->test_download_timeout);
+    } else if (mode == libcore::TcpPing) {
+        req.set_address(profile->bean->DisplayAddress().toStdString());
+    }
 
-                    auto profileId = profile->id;
-                    runOnUiThread([this, profileId] {
-                        refresh_proxy_list(profileId);
-                    });
+    bool rpcOK;
+    auto result = defaultClient->Test(&rpcOK, req);
+    //
+    if (!extCs.empty()) {
+        runOnUiThread(
+            [&] {
+                for (const auto &extC: extCs) {
+                    extC->Kill();
                 }
-            });
-        }
+                extSem.release();
+            },
+            DS_cores);
+        extSem.acquire();
+    }
+    //
+    if (!rpcOK) return;
+
+    if (result.error().empty()) {
+        profile->latency = result.ms();
+        if (profile->latency == 0) profile->latency = 1; // nekoray use 0 to represents not tested
+    } else {
+        profile->latency = -1;
+    }
+    profile->full_test_report = result.full_report().c_str(); // higher priority
+    profile->Save();
+    NekoGui_traffic::trafficHistory->AddLatency(profile->id, profile->latency);
 
-        // Control
-        lock_return.lock();
-        lock_return.unlock();
-        speedtesting = false;
-        MW_show_log(QObject::tr("Speedtest finished."));
+    if (!result.error().empty()) {
+        MW_show_log(tr("[%1] test error: %2").arg(profile->bean->DisplayTypeAndName(), result.error().c_str()));
+    }
+
+    auto profileId = profile->id;
+    runOnUiThread([this, profileId] {
+        refresh_proxy_list(profileId);
     });
 #endif
 }
@@ -249,7 +257,7 @@ void MainWindow::speedtest_current() {
     last_test_time = QTime::currentTime();
     ui->label_running->setText(tr("Testing"));
 
-    runOnNewThread([=] {
+    NekoGui_sys::executor->Submit([=] {
         libcore::TestReq req;
         req.set_mode(libcore::UrlTest);
         req.set_timeout(10 * 1000);
@@ -261,6 +269,7 @@ void MainWindow::speedtest_current() {
 
         auto latency = result.ms();
         last_test_time = QTime::currentTime();
+        NekoGui_traffic::trafficHistory->AddLatency(NekoGui::dataStore->started_id, result.error().empty() ? qMax(latency, 1) : -1);
 
         runOnUiThread([=] {
             if (!result.error().empty()) {
@@ -272,7 +281,7 @@ void MainWindow::speedtest_current() {
                 ui->label_running->setText(tr("Test Result") + ": " + QStringLiteral("%1 ms").arg(latency));
             }
         });
-    });
+    }, NekoGui_sys::TaskClass::IO);
 #endif
 }
 
@@ -299,11 +308,57 @@ void MainWindow::neko_start(int _id) {
     auto group = NekoGui::profileManager->GetGroup(ent->gid);
     if (group == nullptr || group->archive) return;
 
+#ifndef NKR_NO_GRPC
+    // the profile is already behind the running selector, switch without rebuilding
+    if (running != nullptr && running != ent && running_selector.contains(ent->id)) {
+        if (!mu_starting.tryLock()) {
+            MessageBoxWarning(software_name, "Another profile is starting...");
+            return;
+        }
+        auto last = running;
+        auto tag = running_selector[ent->id];
+        NekoGui_sys::executor->Submit([=] {
+            bool rpcOK;
+            QString error = defaultClient->SelectOutbound(&rpcOK, "proxy", tag.toStdString());
+            if (!rpcOK || !error.isEmpty()) {
+                MW_show_log("<<<<<<<< " + tr("Failed to start profile %1").arg(ent->bean->DisplayTypeAndName()) + " " + error);
+                mu_starting.unlock();
+                return;
+            }
+            // "proxy" stats now belong to the selected profile
+            NekoGui_traffic::trafficLooper->loop_mutex.lock();
+            if (NekoGui::dataStore->traffic_loop_interval != 0) NekoGui_traffic::trafficLooper->UpdateAll();
+            last->traffic_data->tag = running_selector[last->id].toStdString();
+            ent->traffic_data->tag = "proxy";
+            NekoGui_traffic::trafficLooper->proxy = ent->traffic_data.get();
+            NekoGui_traffic::trafficLooper->loop_mutex.unlock();
+
+            NekoGui::dataStore->UpdateStartedId(ent->id);
+            running = ent;
+            MW_show_log(">>>>>>>> " + tr("Starting profile %1").arg(ent->bean->DisplayTypeAndName()));
+            mu_starting.unlock();
+
+            runOnUiThread([=] {
+                refresh_status();
+                refresh_proxy_list(last->id);
+                refresh_proxy_list(ent->id);
+            });
+        }, NekoGui_sys::TaskClass::IO, NekoGui_sys::TaskPriority::High);
+        return;
+    }
+#endif
+
     auto result = BuildConfig(ent, false, false);
     if (!result->error.isEmpty()) {
         MessageBoxWarning("BuildConfig return error", result->error);
         return;
     }
+    for (int i = 0; i < result->ruleConflicts.size() && i < 10; i++) {
+        MW_show_log("[Routing] " + result->ruleConflicts[i]);
+    }
+    if (result->ruleConflicts.size() > 10) {
+        MW_show_log(QStringLiteral("[Routing] ... %1 more entries are shadowed").arg(result->ruleConflicts.size() - 10));
+    }
 
     auto neko_start_stage2 = [=] {
 #ifndef NKR_NO_GRPC
@@ -326,6 +381,8 @@ void MainWindow::neko_start(int _id) {
         //
         NekoGui_traffic::trafficLooper->proxy = result->outboundStat.get();
         NekoGui_traffic::trafficLooper->items = result->outboundStats;
+        NekoGui_traffic::trafficLooper->balancers = result->balancerTags;
+        NekoGui_traffic::trafficLooper->balancerMembers = result->balancerMembers;
         NekoGui::dataStore->ignoreConnTag = result->ignoreConnTag;
         NekoGui_traffic::trafficLooper->loop_enabled = true;
 #endif
@@ -339,6 +396,7 @@ void MainWindow::neko_start(int _id) {
 
         NekoGui::dataStore->UpdateStartedId(ent->id);
         running = ent;
+        running_selector = result->selectorMembers;
 
         runOnUiThread([=] {
             refresh_status();
@@ -378,7 +436,7 @@ void MainWindow::neko_start(int _id) {
     connect(restartMsgbox, &QMessageBox::accepted, this, [=] { MW_dialog_message("", "RestartProgram"); });
     auto restartMsgboxTimer = new MessageBoxTimer(this, restartMsgbox, 5000);
 
-    runOnNewThread([=] {
+    NekoGui_sys::executor->Submit([=] {
         // stop current running
         if (NekoGui::dataStore->started_id >= 0) {
             runOnUiThread([=] { neko_stop(false, true); });
@@ -402,7 +460,7 @@ void MainWindow::neko_start(int _id) {
             }
 #endif
         });
-    });
+    }, NekoGui_sys::TaskClass::IO, NekoGui_sys::TaskPriority::High);
 }
 
 void MainWindow::neko_stop(bool crash, bool sem) {
@@ -450,6 +508,7 @@ void MainWindow::neko_stop(bool crash, bool sem) {
         NekoGui::dataStore->UpdateStartedId(-1919);
         NekoGui::dataStore->need_keep_vpn_off = false;
         running = nullptr;
+        running_selector.clear();
 
         runOnUiThread([=] {
             refresh_status();
@@ -470,7 +529,7 @@ void MainWindow::neko_stop(bool crash, bool sem) {
     connect(restartMsgbox, &QMessageBox::accepted, this, [=] { MW_dialog_message("", "RestartProgram"); });
     auto restartMsgboxTimer = new MessageBoxTimer(this, restartMsgbox, 5000);
 
-    runOnNewThread([=] {
+    NekoGui_sys::executor->Submit([=] {
         // do stop
         MW_show_log(">>>>>>>> " + tr("Stopping profile %1").arg(running->bean->DisplayTypeAndName()));
         if (!neko_stop_stage2()) {
@@ -484,7 +543,7 @@ void MainWindow::neko_stop(bool crash, bool sem) {
             restartMsgboxTimer->deleteLater();
             restartMsgbox->deleteLater();
         });
-    });
+    }, NekoGui_sys::TaskClass::IO, NekoGui_sys::TaskPriority::High);
 }
 
 void MainWindow::CheckUpdate() {
@@ -528,7 +587,7 @@ void MainWindow::CheckUpdate() {
         //
         if (btn1 == box.clickedButton() && allow_updater) {
             // Download Update
-            runOnNewThread([=] {
+            NekoGui_sys::executor->Submit([=] {
                 bool ok2;
                 libcore::UpdateReq request2;
                 request2.set_action(libcore::UpdateAction::Download);
@@ -545,7 +604,7 @@ void MainWindow::CheckUpdate() {
                         MessageBoxWarning(QObject::tr("Update"), response2.error().c_str());
                     }
                 });
-            });
+            }, NekoGui_sys::TaskClass::IO);
         } else if (btn2 == box.clickedButton()) {
             QDesktopServices::openUrl(QUrl(response.release_url().c_str()));
         }
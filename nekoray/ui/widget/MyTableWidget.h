@@ -1,36 +1,38 @@
 #pragma once
 
+#include "ProxyListModel.h"
+
 #include <QWidget>
-#include <QTableWidget>
+#include <QTableView>
 #include <QDropEvent>
 #include <QDebug>
+#include <QSet>
+#include <algorithm>
 #include <functional>
 #include <utility>
 
-class MyTableWidget : public QTableWidget {
+class MyTableWidget : public QTableView {
 public:
-    explicit MyTableWidget(QWidget *parent = nullptr) : QTableWidget(parent) {
+    explicit MyTableWidget(QWidget *parent = nullptr) : QTableView(parent) {
+        this->proxyModel = new ProxyListModel(this);
+        this->setModel(proxyModel);
         // 拖拽设置
         this->setDragDropMode(QAbstractItemView::InternalMove); // 内部移动
         this->setDropIndicatorShown(true);                      // drop位置 提示
         this->setSelectionBehavior(QAbstractItemView::SelectRows);
     };
 
-    QList<int> order;          // id sorted (save)
-    std::map<int, int> id2Row; // id2Row
-    QList<int> row2Id;         // row2Id: use this to refresh data
+    ProxyListModel *proxyModel;
+    QList<int> order;  // id sorted (save)
+    QList<int> row2Id; // row2Id: pushed to the model by update_order
+
+    int rowCount() const { return row2Id.size(); }
 
     std::function<void()> callback_save_order;
-    std::function<void(int id)> refresh_data;
 
     void _save_order(bool saveToFile) {
-        order.clear();
-        id2Row.clear();
-        for (int i = 0; i < this->rowCount(); i++) {
-            auto id = row2Id[i];
-            order += id;
-            id2Row[id] = i;
-        }
+        order = row2Id;
+        proxyModel->SetRows(row2Id);
         if (callback_save_order != nullptr && saveToFile)
             callback_save_order();
     }
@@ -42,22 +44,24 @@ public:
         }
 
         // 纠错: order 里面含有不在当前表格控件的 id
-        bool needSave = false;
-        auto deleted_profiles = order;
-        for (int i = 0; i < this->rowCount(); i++) {
-            auto id = row2Id[i];
-            deleted_profiles.removeAll(id);
-        }
-        for (auto deleted_profile: deleted_profiles) {
-            needSave = true;
-            order.removeAll(deleted_profile);
+        QSet<int> rowIds;
+        rowIds.reserve(row2Id.size());
+        for (auto id: row2Id) rowIds << id;
+        auto orderSize = order.size();
+        order.erase(std::remove_if(order.begin(), order.end(), [&](int id) { return !rowIds.contains(id); }), order.end());
+        bool needSave = order.size() != orderSize;
+
+        QHash<int, int> id2Dst;
+        id2Dst.reserve(order.size());
+        for (int i = 0; i < order.size(); i++) {
+            id2Dst[order[i]] = i;
         }
 
         // map(dstRow -> srcId)
         QMap<int, int> newRows;
         for (int i = 0; i < this->rowCount(); i++) {
             auto id = row2Id[i];
-            auto dst = order.indexOf(id);
+            auto dst = id2Dst.value(id, -1);
             if (dst == i) continue;
             if (dst == -1) {
                 // 纠错: 新的profile不需要移动
@@ -79,7 +83,7 @@ public:
 protected:
     /*
      * 2021.7.6 by gy
-     * 拖拽 继承QTableWidget overwrite dropEvent事件
+     * 拖拽 继承QTableView overwrite dropEvent事件
      * 功能：拖动一行到鼠标落下的位置
      * 注意：DragDropMode相关参数的设置
      */
@@ -88,12 +92,13 @@ protected:
 
         // 原行号与目标行号的确定
         int row_src, row_dst;
-        row_src = this->currentRow();                        // 原行号 可加if
-        auto id_src = row2Id[row_src];                       // id_src
-        QTableWidgetItem *item = this->itemAt(event->pos()); // 获取落点的item
-        if (item != nullptr) {
+        row_src = this->currentIndex().row();     // 原行号
+        if (row_src < 0) return;
+        auto id_src = row2Id[row_src];            // id_src
+        auto index = this->indexAt(event->pos()); // 获取落点的index
+        if (index.isValid()) {
             // 判断是否为空
-            row_dst = item->row(); // 不为空 获取其行号
+            row_dst = index.row(); // 不为空 获取其行号
             // Modify order
             order.removeAt(row_src);
             order.insert(row_dst, id_src);
@@ -105,6 +110,5 @@ protected:
         // Do update order & refresh
         clearSelection();
         update_order(true);
-        refresh_data(-1);
     };
 };
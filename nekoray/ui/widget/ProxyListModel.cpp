@@ -0,0 +1,106 @@
+#include "ProxyListModel.h"
+
+#include "db/Database.hpp"
+
+#include <QApplication>
+#include <QPalette>
+
+ProxyListModel::ProxyListModel(QObject *parent) : QAbstractTableModel(parent) {}
+
+void ProxyListModel::SetHeaders(const QStringList &headers_) {
+    headers = headers_;
+    emit headerDataChanged(Qt::Horizontal, 0, columnCount() - 1);
+}
+
+void ProxyListModel::SetRows(const QList<int> &row2Id_) {
+    beginResetModel();
+    row2Id = row2Id_;
+    id2Row.clear();
+    id2Row.reserve(row2Id.size());
+    for (int i = 0; i < row2Id.size(); i++) {
+        id2Row[row2Id[i]] = i;
+    }
+    endResetModel();
+}
+
+int ProxyListModel::IdAt(int row) const {
+    return row2Id.value(row, -1);
+}
+
+int ProxyListModel::RowOf(int id) const {
+    return id2Row.value(id, -1);
+}
+
+void ProxyListModel::Refresh(int id) {
+    if (row2Id.isEmpty()) return;
+    if (id < 0) {
+        emit dataChanged(index(0, 0), index(row2Id.size() - 1, columnCount() - 1));
+        emit headerDataChanged(Qt::Vertical, 0, row2Id.size() - 1);
+        return;
+    }
+    auto row = RowOf(id);
+    if (row < 0) return;
+    emit dataChanged(index(row, 0), index(row, columnCount() - 1));
+    emit headerDataChanged(Qt::Vertical, row, row);
+}
+
+int ProxyListModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : row2Id.size();
+}
+
+int ProxyListModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 5;
+}
+
+QVariant ProxyListModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) return {};
+    auto profileId = row2Id.value(index.row(), -1);
+    if (role == ProfileIdRole) return profileId;
+    if (role != Qt::DisplayRole && role != Qt::ForegroundRole) return {};
+
+    auto profile = NekoGui::profileManager->GetProfile(profileId);
+    if (profile == nullptr) return {};
+    auto isRunning = profileId == NekoGui::dataStore->started_id;
+
+    if (role == Qt::ForegroundRole) {
+        if (index.column() == 3) {
+            if (!profile->full_test_report.isEmpty()) return {};
+            auto color = profile->DisplayLatencyColor();
+            if (color.isValid()) return color;
+            return {};
+        }
+        if (isRunning && index.column() < 3) return QApplication::palette().link();
+        return {};
+    }
+
+    switch (index.column()) {
+        case 0:
+            return profile->meta.type;
+        case 1:
+            return profile->meta.address;
+        case 2:
+            return profile->meta.name;
+        case 3:
+            return profile->full_test_report.isEmpty() ? profile->DisplayLatency() : profile->full_test_report;
+        case 4:
+            return profile->traffic_data->DisplayTraffic();
+        default:
+            return {};
+    }
+}
+
+QVariant ProxyListModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (role != Qt::DisplayRole) return {};
+    if (orientation == Qt::Horizontal) return headers.value(section);
+    // Check state
+    return row2Id.value(section, -1) == NekoGui::dataStore->started_id ? QStringLiteral("✓") : QString::number(section + 1);
+}
+
+Qt::ItemFlags ProxyListModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) return Qt::ItemIsDropEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled | Qt::ItemIsDropEnabled;
+}
+
+Qt::DropActions ProxyListModel::supportedDropActions() const {
+    return Qt::MoveAction;
+}
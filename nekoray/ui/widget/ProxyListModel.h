@@ -0,0 +1,44 @@
+#pragma once
+
+#include <QAbstractTableModel>
+#include <QHash>
+
+// Proxy list of the current group, rendered on demand from the profile manager:
+// the view only asks for the rows it shows, so a large group costs one int per row.
+class ProxyListModel : public QAbstractTableModel {
+    Q_OBJECT
+
+public:
+    static constexpr int ProfileIdRole = 114514;
+
+    explicit ProxyListModel(QObject *parent = nullptr);
+
+    void SetHeaders(const QStringList &headers);
+
+    // Replaces the rows (profile ids, in display order)
+    void SetRows(const QList<int> &row2Id);
+
+    int IdAt(int row) const;
+
+    int RowOf(int id) const;
+
+    // Emits dataChanged for the row of this profile, or for all rows if id < 0
+    void Refresh(int id);
+
+    int rowCount(const QModelIndex &parent = {}) const override;
+
+    int columnCount(const QModelIndex &parent = {}) const override;
+
+    QVariant data(const QModelIndex &index, int role) const override;
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role) const override;
+
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    Qt::DropActions supportedDropActions() const override;
+
+private:
+    QStringList headers;
+    QList<int> row2Id;
+    QHash<int, int> id2Row;
+};
@@ -0,0 +1,97 @@
+#include "StaticAssets.hpp"
+
+#include <QCryptographicHash>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+
+namespace NekoWeb {
+
+    namespace {
+        const QString root = QStringLiteral(":/webui/");
+
+        QByteArray mimeTypeOf(const QString &suffix) {
+            static const QHash<QString, QByteArray> types = {
+                {"html", "text/html; charset=utf-8"},
+                {"css", "text/css; charset=utf-8"},
+                {"js", "text/javascript; charset=utf-8"},
+                {"json", "application/json"},
+                {"svg", "image/svg+xml"},
+                {"png", "image/png"},
+                {"ico", "image/x-icon"},
+            };
+            return types.value(suffix, "application/octet-stream");
+        }
+
+        QByteArray readResource(const QString &path) {
+            QFile f(path);
+            if (!f.open(QIODevice::ReadOnly)) return {};
+            return f.readAll();
+        }
+
+        QByteArray variantTag(const QByteArray &etag, const QByteArray &encoding) {
+            if (encoding.isEmpty()) return etag;
+            return etag.left(etag.size() - 1) + "-" + encoding + "\"";
+        }
+
+        // q of coding in an Accept-Encoding value, 0 when it isn't accepted
+        double qualityOf(const QByteArray &acceptEncoding, const QByteArray &coding) {
+            double wildcard = 0;
+            for (const auto &item: acceptEncoding.split(',')) {
+                auto params = item.split(';');
+                auto name = params.takeFirst().trimmed().toLower();
+                double q = 1;
+                for (const auto &param: params) {
+                    auto p = param.trimmed();
+                    if (p.startsWith("q=")) q = p.mid(2).toDouble();
+                }
+                if (name == coding) return q;
+                if (name == "*") wildcard = q;
+            }
+            return wildcard;
+        }
+    } // namespace
+
+    StaticAssets::StaticAssets() {
+        QDirIterator it(root, QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            auto path = it.next();
+            if (path.endsWith(".gz") || path.endsWith(".br")) continue;
+
+            Asset asset;
+            asset.mimeType = mimeTypeOf(QFileInfo(path).suffix().toLower());
+            asset.identity = readResource(path);
+            asset.gzip = readResource(path + ".gz");
+            asset.brotli = readResource(path + ".br");
+            asset.etag = "\"" + QCryptographicHash::hash(asset.identity, QCryptographicHash::Sha1).toHex().left(20) + "\"";
+            m_assets.insert(path.mid(root.size()), asset);
+        }
+    }
+
+    const StaticAssets::Asset *StaticAssets::Find(const QString &path) const {
+        auto it = m_assets.constFind(path);
+        return it == m_assets.constEnd() ? nullptr : &it.value();
+    }
+
+    StaticAssets::Variant StaticAssets::Negotiate(const Asset &asset, const QByteArray &acceptEncoding) {
+        // br is smaller than gzip for text, so it wins a tie
+        if (!asset.brotli.isEmpty() && asset.brotli.size() < asset.identity.size() && qualityOf(acceptEncoding, "br") > 0) {
+            return {&asset.brotli, "br", variantTag(asset.etag, "br")};
+        }
+        if (!asset.gzip.isEmpty() && asset.gzip.size() < asset.identity.size() && qualityOf(acceptEncoding, "gzip") > 0) {
+            return {&asset.gzip, "gzip", variantTag(asset.etag, "gzip")};
+        }
+        return {&asset.identity, {}, asset.etag};
+    }
+
+    bool StaticAssets::NotModified(const Asset &asset, const QByteArray &ifNoneMatch) {
+        for (auto tag: ifNoneMatch.split(',')) {
+            tag = tag.trimmed();
+            if (tag == "*") return true;
+            if (tag.startsWith("W/")) tag = tag.mid(2); // weak comparison, as RFC 9110 asks for If-None-Match
+            if (tag == asset.etag || tag == variantTag(asset.etag, "br") || tag == variantTag(asset.etag, "gzip")) return true;
+        }
+        return false;
+    }
+
+} // namespace NekoWeb
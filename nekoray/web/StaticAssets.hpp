@@ -0,0 +1,43 @@
+#pragma once
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+namespace NekoWeb {
+
+    // The web UI, embedded under :/webui at build time with its gzip (.gz) and
+    // brotli (.br) variants next to each file. Everything a response needs is
+    // read and hashed once, requests only pick a variant.
+    class StaticAssets {
+    public:
+        struct Asset {
+            QByteArray mimeType;
+            QByteArray etag; // strong, of the content; a compressed variant adds its encoding
+            QByteArray identity;
+            QByteArray gzip;
+            QByteArray brotli;
+        };
+
+        struct Variant {
+            const QByteArray *body;
+            QByteArray encoding; // empty for identity
+            QByteArray etag;
+        };
+
+        StaticAssets();
+
+        // nullptr when there's no such file
+        [[nodiscard]] const Asset *Find(const QString &path) const;
+
+        // Picks the smallest variant acceptEncoding allows.
+        [[nodiscard]] static Variant Negotiate(const Asset &asset, const QByteArray &acceptEncoding);
+
+        // If-None-Match matches any variant of the asset, they all carry the same content.
+        [[nodiscard]] static bool NotModified(const Asset &asset, const QByteArray &ifNoneMatch);
+
+    private:
+        QHash<QString, Asset> m_assets;
+    };
+
+} // namespace NekoWeb
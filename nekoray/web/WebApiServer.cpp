@@ -1,5 +1,7 @@
 #include "WebApiServer.hpp"
-#include "../core/NekoService_Fixed.hpp"
+#include "../core/NekoService.hpp"
+#include "../db/Database.hpp"
+#include "../db/traffic/TrafficHistory.hpp"
 
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -7,6 +9,8 @@
 #include <QUrlQuery>
 #include <QDebug>
 
+#include <algorithm>
+
 namespace NekoWeb {
 
     WebApiServer::WebApiServer(QObject *parent)
@@ -109,6 +113,26 @@ namespace NekoWeb {
                                return handleGetTraffic(request);
                            });
 
+        m_httpServer->route("/api/history", QHttpServerRequest::Method::Get,
+                           [this](const QHttpServerRequest &request) {
+                               return handleGetHistory(request);
+                           });
+
+        m_httpServer->route("/api/serve", QHttpServerRequest::Method::Get,
+                           [this](const QHttpServerRequest &request) {
+                               return handleGetServe(request);
+                           });
+
+        m_httpServer->route("/api/serve", QHttpServerRequest::Method::Post,
+                           [this](const QHttpServerRequest &request) {
+                               return handlePostServe(request);
+                           });
+
+        m_httpServer->route("/api/serve", QHttpServerRequest::Method::Delete,
+                           [this](const QHttpServerRequest &request) {
+                               return handleDeleteServe(request);
+                           });
+
         m_httpServer->route("/api/tun/start", QHttpServerRequest::Method::Post,
                            [this](const QHttpServerRequest &request) {
                                return handlePostTunStart(request);
@@ -132,13 +156,12 @@ namespace NekoWeb {
         // Web UI Route
         m_httpServer->route("/", QHttpServerRequest::Method::Get,
                            [this](const QHttpServerRequest &request) {
-                               return handleGetWebUI(request);
+                               return handleGetWebUI("index.html", request);
                            });
 
         m_httpServer->route("/<arg>", QHttpServerRequest::Method::Get,
                            [this](const QString &path, const QHttpServerRequest &request) {
-                               Q_UNUSED(path)
-                               return handleGetWebUI(request);
+                               return handleGetWebUI(path, request);
                            });
 
         // OPTIONS for CORS
@@ -156,6 +179,7 @@ namespace NekoWeb {
         response["status"] = m_service->getStatusString().toLower();
         response["current_profile"] = m_service->getCurrentProfileId();
         response["tun_running"] = m_service->isTunModeRunning();
+        response["serving"] = m_service->getServePorts().size();
         
         if (m_service->getStatus() == NekoCore::ServiceStatus::Running) {
             QJsonObject proxy;
@@ -181,11 +205,14 @@ namespace NekoWeb {
 
         int profileId = body["profile_id"].toInt();
         
-        if (!m_service->loadProfile(profileId)) {
+        if (NekoGui::profileManager->GetProfile(profileId) == nullptr) {
             return addCorsHeaders(errorResponse("Failed to load profile", 400));
         }
 
-        if (!m_service->startProxy()) {
+        // starting another profile while running switches the core over
+        bool alreadyRunning = m_service->getStatus() == NekoCore::ServiceStatus::Running &&
+                              m_service->getCurrentProfileId() == profileId;
+        if (!alreadyRunning && !m_service->switchProfile(profileId)) {
             return addCorsHeaders(errorResponse("Failed to start proxy", 500));
         }
 
@@ -223,11 +250,11 @@ namespace NekoWeb {
 
         int profileId = body["profile_id"].toInt();
         
-        if (!m_service->loadProfile(profileId)) {
+        if (NekoGui::profileManager->GetProfile(profileId) == nullptr) {
             return addCorsHeaders(errorResponse("Failed to load profile", 400));
         }
 
-        if (!m_service->restartProxy()) {
+        if (!m_service->switchProfile(profileId)) {
             return addCorsHeaders(errorResponse("Failed to restart proxy", 500));
         }
 
@@ -240,18 +267,92 @@ namespace NekoWeb {
     }
 
     QHttpServerResponse WebApiServer::handleGetProfiles(const QHttpServerRequest &request) {
-        Q_UNUSED(request)
-        
-        QJsonArray profiles;
-        
-        // TODO: Implement profile listing from NekoCore service
-        QJsonObject sampleProfile;
-        sampleProfile["id"] = 1;
-        sampleProfile["name"] = "Sample Profile";
-        sampleProfile["type"] = "vmess";
-        profiles.append(sampleProfile);
+        // ?q= &fuzzy=1 search, ?group= filter, ?fields=id,name,... projection,
+        // ?limit= &cursor= pages in id order, ?since=<revision> only what changed after it
+        QUrlQuery query(request.url());
+        auto q = query.queryItemValue("q", QUrl::FullyDecoded);
+        auto fuzzy = query.queryItemValue("fuzzy") == "1";
+
+        bool ok;
+        int group = query.queryItemValue("group").toInt(&ok);
+        if (!ok) group = -1;
+        int cursor = query.queryItemValue("cursor").toInt(&ok);
+        if (!ok) cursor = -1;
+        int limit = query.queryItemValue("limit").toInt(&ok);
+        if (!ok || limit <= 0) limit = 1000;
+        limit = qMin(limit, 10000);
+
+        static const QStringList allFields = {"id", "group_id", "name", "type", "address", "latency", "revision"};
+        auto fields = query.queryItemValue("fields").split(',', Qt::SkipEmptyParts);
+        if (fields.isEmpty()) fields = allFields;
+        for (const auto &field: fields) {
+            if (!allFields.contains(field)) {
+                return addCorsHeaders(errorResponse(QString("Unknown field %1").arg(field), 400));
+            }
+        }
 
+        // read before the table: a change made meanwhile has a later revision, the next sync gets it.
+        // Revisions are "<epoch>:<n>", n restarts with every run of the daemon.
         QJsonObject response;
+        const auto &epoch = NekoGui::profileManager->Epoch();
+        response["revision"] = epoch + ":" + QString::number(NekoGui::profileManager->Revision());
+
+        quint64 since = 0;
+        bool delta = false;
+        QList<int> deleted;
+        if (query.hasQueryItem("since")) {
+            auto sinceParts = query.queryItemValue("since").split(':');
+            if (sinceParts.size() == 2) since = sinceParts[1].toULongLong(&ok);
+            delta = sinceParts.size() == 2 && ok && NekoGui::profileManager->DeletedSince(sinceParts[0], since, deleted);
+            if (!delta) response["reset"] = true; // too old or another run, this is a full listing
+        }
+
+        // one snapshot for the whole response, a running subscription update doesn't block it
+        auto table = NekoGui::profileManager->Profiles();
+        if (delta && cursor < 0) {
+            // with the first page only; an id added again is in the profiles instead
+            QJsonArray deletedIds;
+            for (auto id: deleted) {
+                if (table->profiles.count(id) == 0) deletedIds.append(id);
+            }
+            response["deleted"] = deletedIds;
+        }
+        QList<int> ids;
+        if (q.isEmpty()) {
+            for (auto it = table->profiles.upper_bound(cursor); it != table->profiles.end(); ++it) ids << it->first;
+        } else {
+            for (auto id: NekoGui::profileManager->SearchProfiles(q, fuzzy)) {
+                if (id > cursor) ids << id;
+            }
+            std::sort(ids.begin(), ids.end());
+        }
+
+        QJsonArray profiles;
+        int lastId = -1;
+        for (auto id: ids) {
+            auto it = table->profiles.find(id);
+            if (it == table->profiles.end()) continue;
+            const auto &ent = it->second;
+            if (group >= 0 && ent->gid != group) continue;
+            if (delta && ent->revision <= since) continue;
+            if (profiles.size() == limit) {
+                response["next_cursor"] = lastId;
+                break;
+            }
+            lastId = id;
+
+            QJsonObject profile;
+            profile["id"] = ent->id; // always, cursors and deltas need it
+            for (const auto &field: fields) {
+                if (field == "group_id") profile["group_id"] = ent->gid;
+                else if (field == "name") profile["name"] = ent->meta.name;
+                else if (field == "type") profile["type"] = ent->type;
+                else if (field == "address") profile["address"] = ent->meta.address;
+                else if (field == "latency") profile["latency"] = ent->latency;
+                else if (field == "revision") profile["revision"] = epoch + ":" + QString::number(ent->revision);
+            }
+            profiles.append(profile);
+        }
         response["profiles"] = profiles;
 
         return addCorsHeaders(jsonResponse(response));
@@ -289,6 +390,124 @@ namespace NekoWeb {
         return addCorsHeaders(jsonResponse(response));
     }
 
+    QHttpServerResponse WebApiServer::handleGetHistory(const QHttpServerRequest &request) {
+        QUrlQuery query(request.url());
+        bool ok;
+        int profileId = query.queryItemValue("profile_id").toInt(&ok);
+        if (!ok) {
+            return addCorsHeaders(errorResponse("Missing profile_id", 400));
+        }
+        if (NekoGui::profileManager->GetProfile(profileId) == nullptr) {
+            return addCorsHeaders(errorResponse("Profile not found", 404));
+        }
+
+        static const QMap<QString, NekoGui_traffic::TrafficHistory::Resolution> resolutions = {
+            {"1s", NekoGui_traffic::TrafficHistory::Second},
+            {"1m", NekoGui_traffic::TrafficHistory::Minute},
+            {"1h", NekoGui_traffic::TrafficHistory::Hour},
+        };
+        auto resolutionName = query.hasQueryItem("resolution") ? query.queryItemValue("resolution") : "1m";
+        if (!resolutions.contains(resolutionName)) {
+            return addCorsHeaders(errorResponse("resolution must be 1s, 1m or 1h", 400));
+        }
+
+        auto samples = NekoGui_traffic::trafficHistory->Query(profileId, resolutions[resolutionName],
+                                                               query.queryItemValue("from").toLongLong(),
+                                                               query.queryItemValue("to").toLongLong());
+        QJsonArray points;
+        for (const auto &sample: samples) {
+            QJsonObject point;
+            point["time"] = sample.time;
+            point["upload_bytes"] = sample.uplink;
+            point["download_bytes"] = sample.downlink;
+            point["latency"] = sample.latency_count > 0 ? sample.latency_sum / sample.latency_count : 0;
+            point["latency_tests"] = sample.latency_count + sample.latency_failed;
+            point["latency_failed"] = sample.latency_failed;
+            points.append(point);
+        }
+
+        QJsonObject response;
+        response["profile_id"] = profileId;
+        response["resolution"] = resolutionName;
+        response["points"] = points;
+        return addCorsHeaders(jsonResponse(response));
+    }
+
+    QHttpServerResponse WebApiServer::handleGetServe(const QHttpServerRequest &request) {
+        Q_UNUSED(request)
+
+        auto servePorts = m_service->getServePorts();
+        QJsonArray endpoints;
+        for (auto it = servePorts.cbegin(); it != servePorts.cend(); ++it) {
+            endpoints.append(QJsonObject{{"port", it.key()}, {"profile_id", it.value()}});
+        }
+
+        QJsonObject response;
+        response["serving"] = !servePorts.isEmpty();
+        response["address"] = m_service->getSocksAddress();
+        response["endpoints"] = endpoints;
+        return addCorsHeaders(jsonResponse(response));
+    }
+
+    // {"endpoints": [{"profile_id": 1, "port": 20001}, ...]}
+    // or {"profile_ids": [1, 2, ...], "base_port": 20001} for consecutive ports
+    QHttpServerResponse WebApiServer::handlePostServe(const QHttpServerRequest &request) {
+        if (!validateJsonRequest(request)) {
+            return addCorsHeaders(errorResponse("Invalid JSON request", 400));
+        }
+
+        QJsonObject body = parseRequestBody(request);
+        QList<QPair<int, int>> endpoints; // profile id, port
+        if (body.contains("endpoints")) {
+            for (const auto &value: body["endpoints"].toArray()) {
+                auto endpoint = value.toObject();
+                endpoints.append(qMakePair(endpoint["profile_id"].toInt(-1), endpoint["port"].toInt()));
+            }
+        } else if (body.contains("profile_ids") && body.contains("base_port")) {
+            int port = body["base_port"].toInt();
+            for (const auto &value: body["profile_ids"].toArray()) {
+                endpoints.append(qMakePair(value.toInt(-1), port++));
+            }
+        } else {
+            return addCorsHeaders(errorResponse("Missing endpoints or profile_ids/base_port", 400));
+        }
+        if (endpoints.isEmpty()) {
+            return addCorsHeaders(errorResponse("Nothing to serve", 400));
+        }
+
+        QMap<int, int> servePorts;
+        for (const auto &[profileId, port]: endpoints) {
+            if (!IsValidPort(port)) {
+                return addCorsHeaders(errorResponse(QString("Invalid port %1").arg(port), 400));
+            }
+            if (servePorts.contains(port)) {
+                return addCorsHeaders(errorResponse(QString("Port %1 is used twice").arg(port), 400));
+            }
+            if (NekoGui::profileManager->GetProfile(profileId) == nullptr) {
+                return addCorsHeaders(errorResponse(QString("Profile %1 not found").arg(profileId), 400));
+            }
+            servePorts[port] = profileId;
+        }
+
+        if (!m_service->serve(servePorts)) {
+            return addCorsHeaders(errorResponse("Failed to start serving", 500));
+        }
+        return handleGetServe(request);
+    }
+
+    QHttpServerResponse WebApiServer::handleDeleteServe(const QHttpServerRequest &request) {
+        Q_UNUSED(request)
+
+        if (!m_service->getServePorts().isEmpty() && !m_service->stopProxy()) {
+            return addCorsHeaders(errorResponse("Failed to stop serving", 500));
+        }
+
+        QJsonObject response;
+        response["success"] = true;
+        response["message"] = "Serving stopped";
+        return addCorsHeaders(jsonResponse(response));
+    }
+
     QHttpServerResponse WebApiServer::handlePostTunStart(const QHttpServerRequest &request) {
         Q_UNUSED(request)
         
@@ -344,183 +563,28 @@ namespace NekoWeb {
         return addCorsHeaders(jsonResponse(response));
     }
 
-    QHttpServerResponse WebApiServer::handleGetWebUI(const QHttpServerRequest &request) {
-        Q_UNUSED(request)
-        
-        // Simple embedded web UI
-        QString html = R"(
-<!DOCTYPE html>
-<html>
-<head>
-    <title>NekoRay Web Interface</title>
-    <meta charset="utf-8">
-    <meta name="viewport" content="width=device-width, initial-scale=1">
-    <style>
-        body { font-family: -apple-system, BlinkMacSystemFont, 'Segoe UI', Roboto, sans-serif; margin: 0; padding: 20px; background: #f5f5f5; }
-        .container { max-width: 1200px; margin: 0 auto; background: white; padding: 20px; border-radius: 8px; box-shadow: 0 2px 10px rgba(0,0,0,0.1); }
-        .status-card { background: #f8f9fa; padding: 20px; border-radius: 8px; margin-bottom: 20px; }
-        .btn { padding: 10px 20px; margin: 5px; border: none; border-radius: 4px; cursor: pointer; }
-        .btn-primary { background: #007bff; color: white; }
-        .btn-danger { background: #dc3545; color: white; }
-        .btn-success { background: #28a745; color: white; }
-        .logs { background: #1e1e1e; color: #fff; padding: 15px; border-radius: 4px; font-family: monospace; height: 300px; overflow-y: auto; }
-        .form-group { margin-bottom: 15px; }
-        label { display: block; margin-bottom: 5px; font-weight: bold; }
-        input, select { width: 100%; padding: 8px; border: 1px solid #ddd; border-radius: 4px; }
-    </style>
-</head>
-<body>
-    <div class="container">
-        <h1>NekoRay Web Interface</h1>
-        
-        <div class="status-card">
-            <h2>Service Status</h2>
-            <p id="status">Loading...</p>
-            <p id="proxy-info"></p>
-            <p id="traffic-info"></p>
-        </div>
-
-        <div>
-            <h2>Control Panel</h2>
-            <div class="form-group">
-                <label for="profile-select">Select Profile:</label>
-                <select id="profile-select">
-                    <option value="1">Sample Profile</option>
-                </select>
-            </div>
-            
-            <button class="btn btn-success" onclick="startProxy()">Start Proxy</button>
-            <button class="btn btn-danger" onclick="stopProxy()">Stop Proxy</button>
-            <button class="btn btn-primary" onclick="restartProxy()">Restart Proxy</button>
-            <button class="btn btn-primary" onclick="startTun()">Start TUN</button>
-            <button class="btn btn-danger" onclick="stopTun()">Stop TUN</button>
-        </div>
-
-        <div>
-            <h2>Logs</h2>
-            <div class="logs" id="logs">Loading logs...</div>
-        </div>
-    </div>
-
-    <script>
-        async function apiRequest(path, method = 'GET', body = null) {
-            const options = { method, headers: { 'Content-Type': 'application/json' } };
-            if (body) options.body = JSON.stringify(body);
-            
-            try {
-                const response = await fetch('/api' + path, options);
-                return await response.json();
-            } catch (error) {
-                console.error('API Error:', error);
-                return { error: error.message };
-            }
-        }
-
-        async function updateStatus() {
-            const status = await apiRequest('/status');
-            if (status.error) {
-                document.getElementById('status').textContent = 'Error: ' + status.error;
-                return;
-            }
-            
-            document.getElementById('status').innerHTML = `
-                <strong>Status:</strong> ${status.status}<br>
-                <strong>Current Profile:</strong> ${status.current_profile}<br>
-                <strong>TUN Mode:</strong> ${status.tun_running ? 'Running' : 'Stopped'}
-            `;
-            
-            if (status.proxy) {
-                document.getElementById('proxy-info').innerHTML = `
-                    <strong>SOCKS5:</strong> ${status.proxy.socks_address}:${status.proxy.socks_port}<br>
-                    <strong>HTTP:</strong> ${status.proxy.http_address}:${status.proxy.http_port}
-                `;
-            } else {
-                document.getElementById('proxy-info').innerHTML = '';
-            }
-        }
-
-        async function updateTraffic() {
-            const traffic = await apiRequest('/traffic');
-            if (!traffic.error) {
-                document.getElementById('traffic-info').innerHTML = `
-                    <strong>Upload:</strong> ${formatBytes(traffic.upload_bytes)}<br>
-                    <strong>Download:</strong> ${formatBytes(traffic.download_bytes)}
-                `;
-            }
-        }
-
-        async function updateLogs() {
-            const logs = await apiRequest('/logs');
-            if (!logs.error && logs.logs) {
-                const logsDiv = document.getElementById('logs');
-                logsDiv.innerHTML = logs.logs.map(log => 
-                    `[${log.timestamp}] [${log.level}] ${log.message}`
-                ).join('\\n');
-                logsDiv.scrollTop = logsDiv.scrollHeight;
-            }
+    QHttpServerResponse WebApiServer::handleGetWebUI(const QString &path, const QHttpServerRequest &request) {
+        // a single page UI, other paths get the page itself
+        auto asset = m_assets.Find(path);
+        if (asset == nullptr) asset = m_assets.Find("index.html");
+        if (asset == nullptr) {
+            return errorResponse("Web UI is not built in", 404);
         }
 
-        async function startProxy() {
-            const profileId = document.getElementById('profile-select').value;
-            const result = await apiRequest('/start', 'POST', { profile_id: parseInt(profileId) });
-            alert(result.message || result.error);
-            updateStatus();
+        auto variant = StaticAssets::Negotiate(*asset, request.value("Accept-Encoding"));
+        if (StaticAssets::NotModified(*asset, request.value("If-None-Match"))) {
+            QHttpServerResponse response(QHttpServerResponse::StatusCode::NotModified);
+            response.setHeader("ETag", variant.etag);
+            response.setHeader("Vary", "Accept-Encoding");
+            return response;
         }
 
-        async function stopProxy() {
-            const result = await apiRequest('/stop', 'POST');
-            alert(result.message || result.error);
-            updateStatus();
-        }
-
-        async function restartProxy() {
-            const profileId = document.getElementById('profile-select').value;
-            const result = await apiRequest('/restart', 'POST', { profile_id: parseInt(profileId) });
-            alert(result.message || result.error);
-            updateStatus();
-        }
-
-        async function startTun() {
-            const result = await apiRequest('/tun/start', 'POST');
-            alert(result.message || result.error);
-            updateStatus();
-        }
-
-        async function stopTun() {
-            const result = await apiRequest('/tun/stop', 'POST');
-            alert(result.message || result.error);
-            updateStatus();
-        }
-
-        function formatBytes(bytes) {
-            const units = ['B', 'KB', 'MB', 'GB', 'TB'];
-            let size = bytes;
-            let unitIndex = 0;
-            
-            while (size >= 1024 && unitIndex < units.length - 1) {
-                size /= 1024;
-                unitIndex++;
-            }
-            
-            return size.toFixed(2) + ' ' + units[unitIndex];
-        }
-
-        // Initial load and periodic updates
-        updateStatus();
-        updateTraffic();
-        updateLogs();
-        
-        setInterval(() => {
-            updateStatus();
-            updateTraffic();
-            updateLogs();
-        }, 2000);
-    </script>
-</body>
-</html>
-        )";
-
-        return QHttpServerResponse("text/html", html.toUtf8());
+        QHttpServerResponse response(asset->mimeType, *variant.body);
+        if (!variant.encoding.isEmpty()) response.setHeader("Content-Encoding", variant.encoding);
+        response.setHeader("ETag", variant.etag);
+        response.setHeader("Vary", "Accept-Encoding");
+        response.setHeader("Cache-Control", "no-cache"); // always revalidated, which is a 304 while unchanged
+        return response;
     }
 
     QHttpServerResponse WebApiServer::handleOptionsRequest(const QHttpServerRequest &request) {
@@ -11,6 +11,7 @@
 #include <QSharedPointer>
 
 #include "../core/NekoService.hpp"
+#include "StaticAssets.hpp"
 
 namespace NekoWeb {
 
@@ -38,6 +39,8 @@ namespace NekoWeb {
         void onServiceLogMessage(const QString &level, const QString &message);
 
     private:
+        void setupRoutes();
+
         // API Endpoints
         QHttpServerResponse handleGetStatus(const QHttpServerRequest &request);
         QHttpServerResponse handlePostStart(const QHttpServerRequest &request);
@@ -47,11 +50,15 @@ namespace NekoWeb {
         QHttpServerResponse handleGetConfig(const QHttpServerRequest &request);
         QHttpServerResponse handlePostConfig(const QHttpServerRequest &request);
         QHttpServerResponse handleGetTraffic(const QHttpServerRequest &request);
+        QHttpServerResponse handleGetHistory(const QHttpServerRequest &request);
+        QHttpServerResponse handleGetServe(const QHttpServerRequest &request);
+        QHttpServerResponse handlePostServe(const QHttpServerRequest &request);
+        QHttpServerResponse handleDeleteServe(const QHttpServerRequest &request);
         QHttpServerResponse handlePostTunStart(const QHttpServerRequest &request);
         QHttpServerResponse handlePostTunStop(const QHttpServerRequest &request);
         QHttpServerResponse handleGetLogs(const QHttpServerRequest &request);
         QHttpServerResponse handlePostImport(const QHttpServerRequest &request);
-        QHttpServerResponse handleGetWebUI(const QHttpServerRequest &request);
+        QHttpServerResponse handleGetWebUI(const QString &path, const QHttpServerRequest &request);
 
         // Helper methods
         QHttpServerResponse jsonResponse(const QJsonObject &data, int statusCode = 200);
@@ -73,6 +80,8 @@ namespace NekoWeb {
 
         // Statistics
         QJsonObject m_lastTrafficStats;
+
+        StaticAssets m_assets;
     };
 
 } // namespace NekoWeb
\ No newline at end of file